@@ -0,0 +1,232 @@
+#ifndef SJTU_BOUNDED_DEQUE_HPP
+#define SJTU_BOUNDED_DEQUE_HPP
+
+#include "deque.hpp"
+#include "index_iterator.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace sjtu {
+
+/**
+ * A deque of at most capacity elements, for sliding windows: a ring of
+ * capacity slots allocated by the constructor, and nothing after that.
+ * There are no blocks to split or merge, so there is no Balance() and
+ * every end operation is O(1) without touching the allocator.
+ *
+ * When the ring is full, push_back overwrites the oldest element (the
+ * front) and push_front overwrites the newest one (the back), so the
+ * window slides; try_push_back / try_push_front return false instead
+ * and leave the deque alone.
+ *
+ * Element access and iterators are those of deque: at / operator[]
+ * (bounds checked, throwing std::out_of_range), front / back, and
+ * random access iterators. Iterators are positions, so after an
+ * overwrite an iterator at index i refers to the new i-th element.
+ *
+ * A moved-from bounded_deque has no ring: it is empty with capacity()
+ * 0, push_back / push_front (and emplace_*) throw std::out_of_range,
+ * try_push_* return false, and assigning to it gives it a ring again.
+ */
+template <class T, class Alloc = std::allocator<T>>
+class bounded_deque {
+private:
+  typedef std::allocator_traits<Alloc> traits;
+
+  Alloc alloc;
+  T *data = nullptr;
+  size_t cap = 0;
+  size_t head = 0;   // slot of the front element
+  size_t count = 0;
+
+  T *Element(size_t i) const {
+    i += head;
+    return data + (i < cap ? i : i - cap);
+  }
+
+  void DestroyAll() {
+    if (!std::is_trivially_destructible<T>::value)
+      for (size_t i = 0; i < count; ++i) Element(i)->~T();
+    head = count = 0;
+  }
+
+  template <class, class, bool, bool> friend class index_iterator;
+
+public:
+  typedef index_iterator<bounded_deque, T, false, SJTU_DEQUE_CHECKED> iterator;
+  typedef index_iterator<bounded_deque, T, true, SJTU_DEQUE_CHECKED> const_iterator;
+
+  // room for capacity elements, allocated here once; throw if capacity is 0
+  explicit bounded_deque(size_t capacity, const Alloc &a = Alloc()) : alloc(a), cap(capacity) {
+    if (capacity == 0) throw std::out_of_range("");
+    data = traits::allocate(alloc, cap);
+  }
+
+  bounded_deque(const bounded_deque &other)
+    : alloc(traits::select_on_container_copy_construction(other.alloc)), cap(other.cap) {
+    if (cap == 0) return;  // a copy of a moved-from deque has no ring either
+    data = traits::allocate(alloc, cap);
+    try {
+      for (; count < other.count; ++count) ::new (static_cast<void *>(data + count)) T(*other.Element(count));
+    } catch (...) {
+      DestroyAll();
+      traits::deallocate(alloc, data, cap);
+      throw;
+    }
+  }
+
+  // takes other's ring; other is left empty without one (capacity() == 0) until assigned to
+  bounded_deque(bounded_deque &&other) noexcept
+    : alloc(std::move(other.alloc)), data(other.data), cap(other.cap), head(other.head), count(other.count) {
+    other.data = nullptr;
+    other.cap = other.head = other.count = 0;
+  }
+
+  ~bounded_deque() {
+    DestroyAll();
+    if (data) traits::deallocate(alloc, data, cap);
+  }
+
+  bounded_deque &operator=(const bounded_deque &other) {
+    if (this == &other) return *this;
+    bounded_deque copy(other);  // if an element copy throws, *this is untouched
+    swap(copy);
+    return *this;
+  }
+
+  bounded_deque &operator=(bounded_deque &&other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  void swap(bounded_deque &other) noexcept {
+    std::swap(alloc, other.alloc);
+    std::swap(data, other.data);
+    std::swap(cap, other.cap);
+    std::swap(head, other.head);
+    std::swap(count, other.count);
+  }
+
+  bool empty() const { return count == 0; }
+  bool full() const { return count == cap; }
+  size_t size() const { return count; }
+  size_t capacity() const { return cap; }
+
+  /**
+   * access specified element with bounds checking
+   * throw index_out_of_bound if out of bound.
+   */
+  T &at(const size_t &pos) {
+    if (pos >= count) throw std::out_of_range("");
+    return *Element(pos);
+  }
+  const T &at(const size_t &pos) const {
+    if (pos >= count) throw std::out_of_range("");
+    return *Element(pos);
+  }
+  T &operator[](const size_t &pos) { return at(pos); }
+  const T &operator[](const size_t &pos) const { return at(pos); }
+
+  // throw when the container is empty
+  T &front() { return at(0); }
+  const T &front() const { return at(0); }
+  T &back() {
+    if (count == 0) throw std::out_of_range("");
+    return *Element(count - 1);
+  }
+  const T &back() const {
+    if (count == 0) throw std::out_of_range("");
+    return *Element(count - 1);
+  }
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, count); }
+  const_iterator cbegin() const { return const_iterator(this, 0); }
+  const_iterator cend() const { return const_iterator(this, count); }
+
+  void clear() { DestroyAll(); }
+
+  /**
+   * construct an element behind the last one. When the deque is full the
+   * new element takes the oldest one's slot (by move assignment) and
+   * becomes the back, so the front moves on by one. Throws
+   * std::out_of_range if the deque has no ring (it was moved from).
+   */
+  template <class... Args>
+  void emplace_back(Args&&... args) {
+    if (cap == 0) throw std::out_of_range("");
+    if (count == cap) {
+      T value(std::forward<Args>(args)...);  // args may refer to the element it replaces
+      *Element(0) = std::move(value);
+      head = head + 1 == cap ? 0 : head + 1;
+      return;
+    }
+    ::new (static_cast<void *>(Element(count))) T(std::forward<Args>(args)...);
+    ++count;
+  }
+  void push_back(const T &value) { emplace_back(value); }
+  void push_back(T &&value) { emplace_back(std::move(value)); }
+
+  // the mirror image: when full, the newest element (the back) is overwritten
+  template <class... Args>
+  void emplace_front(Args&&... args) {
+    if (cap == 0) throw std::out_of_range("");
+    size_t slot = head ? head - 1 : cap - 1;
+    if (count == cap) {
+      T value(std::forward<Args>(args)...);
+      data[slot] = std::move(value);  // the back lives in the slot before the front
+      head = slot;
+      return;
+    }
+    ::new (static_cast<void *>(data + slot)) T(std::forward<Args>(args)...);
+    head = slot;
+    ++count;
+  }
+  void push_front(const T &value) { emplace_front(value); }
+  void push_front(T &&value) { emplace_front(std::move(value)); }
+
+  // false, without touching value, when the deque is full
+  bool try_push_back(const T &value) {
+    if (count == cap) return false;
+    emplace_back(value);
+    return true;
+  }
+  bool try_push_back(T &&value) {
+    if (count == cap) return false;
+    emplace_back(std::move(value));
+    return true;
+  }
+  bool try_push_front(const T &value) {
+    if (count == cap) return false;
+    emplace_front(value);
+    return true;
+  }
+  bool try_push_front(T &&value) {
+    if (count == cap) return false;
+    emplace_front(std::move(value));
+    return true;
+  }
+
+  // throw when the container is empty
+  void pop_back() {
+    if (count == 0) throw std::out_of_range("");
+    Element(--count)->~T();
+  }
+
+  void pop_front() {
+    if (count == 0) throw std::out_of_range("");
+    data[head].~T();
+    head = head + 1 == cap ? 0 : head + 1;
+    --count;
+  }
+};
+
+} // namespace sjtu
+
+#endif
@@ -249,6 +249,7 @@ Bint &Bint::operator=(Bint &&rhs) noexcept
     capacity = rhs.capacity;
     length = rhs.length;
     isMinus = rhs.isMinus;
+    delete[] data;
     data = rhs.data;
     rhs.data = nullptr;
     return *this;
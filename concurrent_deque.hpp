@@ -0,0 +1,246 @@
+#ifndef SJTU_CONCURRENT_DEQUE_HPP
+#define SJTU_CONCURRENT_DEQUE_HPP
+
+#include "deque.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+
+namespace sjtu {
+
+/**
+ * MPMC two-ended deque with one lock per end. Any number of threads may
+ * push and pop at either end; push_front / pop_front only take the front
+ * lock and push_back / pop_back only take the back lock, so one thread
+ * per end runs without contending.
+ *
+ * The chain is made of fixed-capacity blocks (sized by a fixed_block /
+ * fixed_bytes Policy), each holding a contiguous run [lo, hi) of its
+ * slots: the front block grows downwards, the back block upwards, and
+ * every block but a lone one is non-empty. An end operation touches
+ * only its end block and, when that block fills up or drains, one link
+ * of its neighbour. With three or more blocks the two ends therefore
+ * never share a field; with one or two blocks an operation takes both
+ * locks (front first, then back). Blocks never split or merge, so there
+ * is no Balance() pass to stall either end.
+ */
+template <class T, class Alloc = std::allocator<T>, class Policy = fixed_bytes<>>
+class concurrent_deque {
+private:
+  static const size_t kCap = detail::fixed_capacity<Policy, T>::value;
+  static_assert(kCap != 0, "concurrent_deque needs a fixed-capacity Policy (fixed_block / fixed_bytes)");
+  static const size_t kLine = 64;
+
+  typedef std::allocator_traits<Alloc> traits;
+
+  struct Block {
+    T *data;
+    size_t lo, hi;  // the elements are data[lo, hi)
+    Block *prev = nullptr;
+    Block *next = nullptr;
+    Block(T *d, size_t at) : data(d), lo(at), hi(at) {}
+  };
+  typedef typename traits::template rebind_alloc<Block> block_alloc;
+  typedef std::allocator_traits<block_alloc> block_traits;
+
+  Alloc alloc;
+  std::atomic<size_t> block_count{1};
+  std::atomic<size_t> total_size{0};
+
+  // front end: front block and a spare for it
+  alignas(kLine) std::mutex front_lock;
+  Block *front_block;
+  Block *front_spare = nullptr;
+
+  // back end
+  alignas(kLine) std::mutex back_lock;
+  Block *back_block;
+  Block *back_spare = nullptr;
+
+  Block *NewBlock(Block *&spare, size_t at) {
+    Block *b = spare;
+    if (b) {
+      spare = nullptr;
+      b->lo = b->hi = at;
+      return b;
+    }
+    T *data = traits::allocate(alloc, kCap);
+    block_alloc ba(alloc);
+    try {
+      b = block_traits::allocate(ba, 1);
+    } catch (...) {
+      traits::deallocate(alloc, data, kCap);
+      throw;
+    }
+    ::new (static_cast<void *>(b)) Block(data, at);
+    return b;
+  }
+
+  void FreeBlock(Block *b) {
+    if (!b) return;
+    traits::deallocate(alloc, b->data, kCap);
+    b->~Block();
+    block_alloc ba(alloc);
+    block_traits::deallocate(ba, b, 1);
+  }
+
+  // drop an emptied end block, keeping it as that end's spare
+  void Retire(Block *b, Block *&spare) {
+    b->prev = b->next = nullptr;
+    FreeBlock(spare);
+    spare = b;
+    block_count.fetch_sub(1);
+  }
+
+  // the lock(s) an operation at one end needs; see the class comment
+  class Guard {
+  public:
+    Guard(concurrent_deque &d, bool front) : first(front ? d.front_lock : d.back_lock), second(nullptr) {
+      first.lock();
+      if (d.block_count.load() > 2) return;
+      if (front) {
+        second = &d.back_lock;
+        second->lock();
+      } else {  // keep the front-then-back order
+        first.unlock();
+        d.front_lock.lock();
+        first.lock();
+        second = &d.front_lock;
+      }
+    }
+    ~Guard() {
+      first.unlock();
+      if (second) second->unlock();
+    }
+    Guard(const Guard &) = delete;
+    Guard &operator=(const Guard &) = delete;
+
+  private:
+    std::mutex &first;
+    std::mutex *second;
+  };
+
+  template <class... Args>
+  void EmplaceFront(Args &&...args) {
+    Guard guard(*this, true);
+    Block *b = front_block;
+    if (b->lo == b->hi) b->lo = b->hi = kCap;  // an empty lone block: keep it, not a new one, in use
+    if (b->lo == 0) {
+      Block *fresh = NewBlock(front_spare, kCap);
+      try {
+        ::new (static_cast<void *>(fresh->data + kCap - 1)) T(std::forward<Args>(args)...);
+      } catch (...) {
+        front_spare = fresh;
+        throw;
+      }
+      fresh->lo = kCap - 1;
+      fresh->next = b;
+      b->prev = fresh;
+      front_block = fresh;
+      block_count.fetch_add(1);
+    } else {
+      ::new (static_cast<void *>(b->data + b->lo - 1)) T(std::forward<Args>(args)...);
+      --b->lo;
+    }
+    total_size.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  template <class... Args>
+  void EmplaceBack(Args &&...args) {
+    Guard guard(*this, false);
+    Block *b = back_block;
+    if (b->lo == b->hi) b->lo = b->hi = 0;
+    if (b->hi == kCap) {
+      Block *fresh = NewBlock(back_spare, 0);
+      try {
+        ::new (static_cast<void *>(fresh->data)) T(std::forward<Args>(args)...);
+      } catch (...) {
+        back_spare = fresh;
+        throw;
+      }
+      fresh->hi = 1;
+      fresh->prev = b;
+      b->next = fresh;
+      back_block = fresh;
+      block_count.fetch_add(1);
+    } else {
+      ::new (static_cast<void *>(b->data + b->hi)) T(std::forward<Args>(args)...);
+      ++b->hi;
+    }
+    total_size.fetch_add(1, std::memory_order_relaxed);
+  }
+
+public:
+  concurrent_deque() { front_block = back_block = NewBlock(front_spare, kCap / 2); }
+
+  concurrent_deque(const concurrent_deque &) = delete;
+  concurrent_deque &operator=(const concurrent_deque &) = delete;
+
+  // not concurrent with any other member
+  ~concurrent_deque() {
+    for (Block *b = front_block; b;) {
+      for (size_t i = b->lo; i < b->hi; ++i) b->data[i].~T();
+      Block *next = b->next;
+      FreeBlock(b);
+      b = next;
+    }
+    FreeBlock(front_spare);
+    FreeBlock(back_spare);
+  }
+
+  void push_front(const T &value) { EmplaceFront(value); }
+  void push_front(T &&value) { EmplaceFront(std::move(value)); }
+  void push_back(const T &value) { EmplaceBack(value); }
+  void push_back(T &&value) { EmplaceBack(std::move(value)); }
+
+  template <class... Args>
+  void emplace_front(Args &&...args) { EmplaceFront(std::forward<Args>(args)...); }
+  template <class... Args>
+  void emplace_back(Args &&...args) { EmplaceBack(std::forward<Args>(args)...); }
+
+  // moves the first element into out and removes it; false when empty
+  bool try_pop_front(T &out) {
+    Guard guard(*this, true);
+    Block *b = front_block;
+    if (b->lo == b->hi) return false;  // only a lone block can be empty
+    out = std::move(b->data[b->lo]);
+    b->data[b->lo].~T();
+    ++b->lo;
+    total_size.fetch_sub(1, std::memory_order_relaxed);
+    if (b->lo == b->hi && b->next) {
+      front_block = b->next;
+      front_block->prev = nullptr;
+      Retire(b, front_spare);
+    }
+    return true;
+  }
+
+  // moves the last element into out and removes it; false when empty
+  bool try_pop_back(T &out) {
+    Guard guard(*this, false);
+    Block *b = back_block;
+    if (b->lo == b->hi) return false;
+    out = std::move(b->data[b->hi - 1]);
+    b->data[b->hi - 1].~T();
+    --b->hi;
+    total_size.fetch_sub(1, std::memory_order_relaxed);
+    if (b->lo == b->hi && b->prev) {
+      back_block = b->prev;
+      back_block->next = nullptr;
+      Retire(b, back_spare);
+    }
+    return true;
+  }
+
+  // a snapshot, possibly stale by the time it returns
+  size_t size() const { return total_size.load(std::memory_order_relaxed); }
+  bool empty() const { return size() == 0; }
+};
+
+} // namespace sjtu
+
+#endif
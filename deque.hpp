@@ -5,43 +5,364 @@
 
 #include <cstddef>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
 #include <iterator>
 #include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ * SJTU_DEQUE_CHECKED turns on the iterator bounds checks: dereferencing
+ * end() or stepping past either end throws std::out_of_range. It is on
+ * unless NDEBUG is defined; define it to 0 for bare iterators in any build.
+ */
+#ifndef SJTU_DEQUE_CHECKED
+#ifdef NDEBUG
+#define SJTU_DEQUE_CHECKED 0
+#else
+#define SJTU_DEQUE_CHECKED 1
+#endif
+#endif
+
+/**
+ * SJTU_DEQUE_PROFILE compiles in the instrumentation behind
+ * deque::profile(): call counts, latency histograms and directory walk
+ * lengths of the internals. Off by default; with it off no counter or
+ * clock read exists in the deque.
+ */
+#ifndef SJTU_DEQUE_PROFILE
+#define SJTU_DEQUE_PROFILE 0
+#endif
+
+#if SJTU_DEQUE_PROFILE
+#include <chrono>
+#endif
 
 namespace sjtu {
 
-template<typename T>
+/**
+ * Pool of fixed-size objects. Memory is taken from Alloc in slabs that
+ * double in size up to 1024 objects; freed objects go onto an intrusive
+ * free list and are handed out again before a new slab is carved.
+ * release() gives every slab back to Alloc at once, so an owner that has
+ * already destroyed its objects never frees them one by one.
+ */
+template <class T, class Alloc = std::allocator<T>>
+class node_pool {
+private:
+    union Cell;
+    struct SlabHeader {
+        Cell *next;
+        std::size_t cells;
+    };
+    union Cell {
+        Cell *next;  // 空闲链表
+        SlabHeader header;  // 每个 slab 的第一个 cell
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<Cell> cell_allocator;
+    typedef std::allocator_traits<cell_allocator> cell_traits;
+
+    cell_allocator alloc;
+    Cell *free_list = nullptr;
+    Cell *slabs = nullptr;
+    Cell *cursor = nullptr;
+    Cell *limit = nullptr;
+    std::size_t next_cells = 16;
+    std::size_t bytes_ = 0;  // held in slabs right now
+    std::size_t allocations_ = 0;  // slabs ever carved
+
+    void grow() {
+        std::size_t cells = next_cells + 1;
+        Cell *slab = cell_traits::allocate(alloc, cells);
+        bytes_ += cells * sizeof(Cell);
+        ++allocations_;
+        slab->header.next = slabs;
+        slab->header.cells = cells;
+        slabs = slab;
+        cursor = slab + 1;
+        limit = slab + cells;
+        if (next_cells < 1024) next_cells *= 2;
+    }
+
+public:
+    node_pool() {}
+    node_pool(const node_pool &) = delete;
+    node_pool &operator=(const node_pool &) = delete;
+    ~node_pool() { release(); }
+
+    T *allocate() {
+        Cell *cell;
+        if (free_list) {
+            cell = free_list;
+            free_list = free_list->next;
+        } else {
+            if (cursor == limit) grow();
+            cell = cursor++;
+        }
+        return reinterpret_cast<T *>(cell->storage);
+    }
+
+    void deallocate(T *p) {
+        Cell *cell = reinterpret_cast<Cell *>(p);
+        cell->next = free_list;
+        free_list = cell;
+    }
+
+    void swap(node_pool &other) noexcept {
+        std::swap(alloc, other.alloc);
+        std::swap(free_list, other.free_list);
+        std::swap(slabs, other.slabs);
+        std::swap(cursor, other.cursor);
+        std::swap(limit, other.limit);
+        std::swap(next_cells, other.next_cells);
+        std::swap(bytes_, other.bytes_);
+        std::swap(allocations_, other.allocations_);
+    }
+
+    std::size_t bytes() const { return bytes_; }
+    std::size_t allocations() const { return allocations_; }
+
+    /**
+     * Take over every slab of other, which is left empty. Objects other
+     * handed out stay valid and are now owned (and later released) by
+     * this pool; cells still free in other are not reused until then.
+     * Both pools must use allocators that compare equal.
+     */
+    void absorb(node_pool &other) {
+        if (!other.slabs) return;
+        Cell *last = other.slabs;
+        while (last->header.next) last = last->header.next;
+        last->header.next = slabs;
+        slabs = other.slabs;
+        bytes_ += other.bytes_;
+        other.slabs = other.free_list = other.cursor = other.limit = nullptr;
+        other.next_cells = 16;
+        other.bytes_ = 0;
+    }
+
+    void release() {
+        while (slabs) {
+            Cell *slab = slabs;
+            slabs = slab->header.next;
+            cell_traits::deallocate(alloc, slab, slab->header.cells);
+        }
+        free_list = cursor = limit = nullptr;
+        next_cells = 16;
+        bytes_ = 0;
+    }
+};
+
+/**
+ * Cache of deque block buffers. A freed buffer is kept (the kKeep most
+ * recent ones) and handed to the next block asking for the same capacity, so
+ * push/pop churn at either end of a deque stops reaching the allocator.
+ * The cache links buffers through their own first bytes, which is why
+ * a block buffer is never smaller than a Header.
+ */
+template <class T, class Alloc = std::allocator<T>>
+class buffer_pool {
+private:
+    struct Header {
+        T *next;
+        std::size_t cap;
+    };
+    typedef std::allocator_traits<Alloc> traits;
+    static const std::size_t kKeep = 8;
+
+    Alloc alloc;
+    T *cache = nullptr;
+    std::size_t cached = 0;
+    std::size_t cached_bytes_ = 0;
+    std::size_t allocations_ = 0;  // cache misses that reached Alloc
+
+    static Header read(T *p) {
+        Header h;
+        std::memcpy(&h, static_cast<void *>(p), sizeof(Header));
+        return h;
+    }
+    static void write(T *p, const Header &h) {
+        std::memcpy(static_cast<void *>(p), &h, sizeof(Header));
+    }
+
+public:
+    static const std::size_t min_bytes = sizeof(Header);
+
+    buffer_pool() {}
+    buffer_pool(const buffer_pool &) = delete;
+    buffer_pool &operator=(const buffer_pool &) = delete;
+    ~buffer_pool() { release(); }
+
+    T *allocate(std::size_t cap) {
+        T *prev = nullptr;
+        for (T *cur = cache; cur; cur = read(cur).next) {
+            Header h = read(cur);
+            if (h.cap == cap) {
+                if (prev) {
+                    Header p = read(prev);
+                    p.next = h.next;
+                    write(prev, p);
+                } else {
+                    cache = h.next;
+                }
+                --cached;
+                cached_bytes_ -= cap * sizeof(T);
+                return cur;
+            }
+            prev = cur;
+        }
+        T *p = traits::allocate(alloc, cap);
+        ++allocations_;
+        return p;
+    }
+
+    void deallocate(T *p, std::size_t cap) {
+        if (cached == kKeep) {  // evict the oldest, so stale capacities age out
+            T *prev = nullptr, *last = cache;
+            for (T *next = read(last).next; next; next = read(next).next) {
+                prev = last;
+                last = next;
+            }
+            if (prev) {
+                Header h = read(prev);
+                h.next = nullptr;
+                write(prev, h);
+            } else {
+                cache = nullptr;
+            }
+            cached_bytes_ -= read(last).cap * sizeof(T);
+            traits::deallocate(alloc, last, read(last).cap);
+            --cached;
+        }
+        write(p, Header{cache, cap});
+        cache = p;
+        ++cached;
+        cached_bytes_ += cap * sizeof(T);
+    }
+
+    void swap(buffer_pool &other) noexcept {
+        std::swap(alloc, other.alloc);
+        std::swap(cache, other.cache);
+        std::swap(cached, other.cached);
+        std::swap(cached_bytes_, other.cached_bytes_);
+        std::swap(allocations_, other.allocations_);
+    }
+
+    std::size_t cached_bytes() const { return cached_bytes_; }
+    std::size_t allocations() const { return allocations_; }
+
+    void release() {
+        while (cache) {
+            Header h = read(cache);
+            traits::deallocate(alloc, cache, h.cap);
+            cache = h.next;
+        }
+        cached = 0;
+        cached_bytes_ = 0;
+    }
+};
+
+template<typename T, class Alloc = std::allocator<T>>
 class double_list {
 private:
     struct Node {
-        std::shared_ptr<T> data;  // 使用 shared_ptr 管理内存
+        T data;  // 元素直接存放在结点内
         Node* pre;
         Node* nxt;
-        Node(const T& val)
-            : data(std::make_shared<T>(val)), pre(nullptr), nxt(nullptr) {}
+        template <class... Args>
+        explicit Node(Args&&... args)  // 原地构造元素
+            : data(std::forward<Args>(args)...), pre(nullptr), nxt(nullptr) {}
     };
 
     Node* head;
     Node* tail;
     std::size_t size_;  // 跟踪列表大小
+    node_pool<Node, Alloc> pool;  // 结点内存池
+
+    template <class... Args>
+    Node* create_node(Args&&... args) {
+        Node* node = pool.allocate();
+        try {
+            new (node) Node(std::forward<Args>(args)...);
+        } catch (...) {
+            pool.deallocate(node);
+            throw;
+        }
+        return node;
+    }
+
+    void destroy_node(Node* node) {
+        node->~Node();
+        pool.deallocate(node);  // 归还到空闲链表
+    }
+
+    // 把链 [first, last] 接到 pos 之前 (pos 为空则接到尾部)
+    void link_before(Node* pos, Node* first, Node* last) {
+        Node* prev = pos ? pos->pre : tail;
+        first->pre = prev;
+        last->nxt = pos;
+        if (prev) prev->nxt = first; else head = first;
+        if (pos) pos->pre = last; else tail = last;
+    }
+
+    // 把链 [first, last] 从本列表摘下, 不释放结点
+    void unlink(Node* first, Node* last) {
+        if (first->pre) first->pre->nxt = last->nxt; else head = last->nxt;
+        if (last->nxt) last->nxt->pre = first->pre; else tail = first->pre;
+        first->pre = last->nxt = nullptr;
+    }
 
 public:
     double_list() : head(nullptr), tail(nullptr), size_(0) {}
 
-    double_list(const double_list<T>& other) {
+    double_list(const double_list& other) : size_(0) {
         head = tail = nullptr;  // 初始化
         Node* current = other.head;  // 从另一个列表复制
         while (current) {
-            insert_tail(*current->data);  // 插入尾部
+            insert_tail(current->data);  // 插入尾部
             current = current->nxt;
         }
         size_ = other.size_;  // 更新大小
     }
 
+    double_list(double_list&& other) noexcept : head(nullptr), tail(nullptr), size_(0) {
+        swap(other);  // 直接接管结点和内存池
+    }
+
     ~double_list() {
         clear();  // 清理所有节点
     }
 
+    double_list& operator=(const double_list& other) {
+        if (this == &other) return *this;
+        clear();
+        for (Node* current = other.head; current; current = current->nxt) {
+            insert_tail(current->data);
+        }
+        return *this;
+    }
+
+    double_list& operator=(double_list&& other) noexcept {
+        if (this == &other) return *this;
+        clear();
+        swap(other);
+        return *this;
+    }
+
+    void swap(double_list& other) noexcept {
+        std::swap(head, other.head);
+        std::swap(tail, other.tail);
+        std::swap(size_, other.size_);
+        pool.swap(other.pool);
+    }
+
+    std::size_t pool_bytes() const { return pool.bytes(); }  // 结点内存池当前占用
+    std::size_t pool_allocations() const { return pool.allocations(); }
+
     class iterator {
     public:
         using difference_type = std::ptrdiff_t;  // 添加 difference_type
@@ -56,20 +377,15 @@ public:
 
         iterator operator++(int) {  // 后缀增量
             iterator temp = *this;
-            if (current) {
-                current = current->nxt;  // 移动到下一个节点
-            } else {
-                throw std::out_of_range("Iterator out of range");
-            }
+            ++*this;
             return temp;
         }
 
         iterator& operator++() {  // 前缀增量
-            if (current) {
-                current = current->nxt;  // 移动到下一个节点
-            } else {
-                throw std::out_of_range("Iterator out of range");
-            }
+#if SJTU_DEQUE_CHECKED
+            if (!current) throw std::out_of_range("Iterator out of range");
+#endif
+            current = current->nxt;  // 移动到下一个节点
             return *this;
         }
 
@@ -93,14 +409,14 @@ public:
         }
 
         T& operator*() const {  // 解引用
-            if (!current) {
-                throw std::out_of_range("Iterator out of range");
-            }
-            return *current->data;  // 返回数据
+#if SJTU_DEQUE_CHECKED
+            if (!current) throw std::out_of_range("Iterator out of range");
+#endif
+            return current->data;  // 返回数据
         }
 
         T* operator->() const noexcept {  // 指针访问
-            return current ? current->data.get() : nullptr;  // 返回指向数据的指针
+            return current ? &current->data : nullptr;  // 返回指向数据的指针
         }
 
         bool operator==(const iterator& rhs) const {  // 检查相等
@@ -141,15 +457,16 @@ public:
         }
 
         Node *node = node_to_delete->nxt;
-        delete node_to_delete;  // 释放节点
+        destroy_node(node_to_delete);  // 释放节点
         size_--;  // 更新大小
 
         return iterator(node);  // 返回下一个迭代器
     }
 
-    iterator insert(iterator pos, const T& value) {
+    template <class... Args>
+    iterator emplace(iterator pos, Args&&... args) {
         if(pos == end()) {
-            insert_tail(value);
+            emplace_tail(std::forward<Args>(args)...);
             return iterator(tail);
         }
 
@@ -157,7 +474,7 @@ public:
             throw std::out_of_range("Invalid iterator");
         }
 
-        Node* new_node = new Node(value);  // 创建新节点
+        Node* new_node = create_node(std::forward<Args>(args)...);  // 创建新节点
         Node* current = pos.current;
 
         if (current->pre) {  // 如果不是在头部
@@ -174,8 +491,17 @@ public:
         return iterator(new_node);  // 返回新迭代器
     }
 
-    void insert_head(const T& value) {
-        Node* new_node = new Node(value);  // 创建新节点
+    iterator insert(iterator pos, const T& value) {
+        return emplace(pos, value);
+    }
+
+    iterator insert(iterator pos, T&& value) {
+        return emplace(pos, std::move(value));
+    }
+
+    template <class... Args>
+    void emplace_head(Args&&... args) {
+        Node* new_node = create_node(std::forward<Args>(args)...);  // 创建新节点
         if (!head) {  // 如果是空列表
             head = tail = new_node;
         } else {
@@ -186,8 +512,9 @@ public:
         size_++;  // 更新大小
     }
 
-    void insert_tail(const T& value) {
-        Node* new_node = new Node(value);  // 创建新节点
+    template <class... Args>
+    void emplace_tail(Args&&... args) {
+        Node* new_node = create_node(std::forward<Args>(args)...);  // 创建新节点
         if (!tail) {  // 如果是空列表
             head = tail = new_node;
         } else {
@@ -198,6 +525,54 @@ public:
         size_++;  // 更新大小
     }
 
+    void insert_head(const T& value) { emplace_head(value); }
+    void insert_head(T&& value) { emplace_head(std::move(value)); }
+    void insert_tail(const T& value) { emplace_tail(value); }
+    void insert_tail(T&& value) { emplace_tail(std::move(value)); }
+
+    /**
+     * Move all of other's nodes in front of pos by relinking them; no
+     * element is copied or moved. other's slabs are absorbed into this
+     * list's pool, so the nodes stay where they are in memory.
+     */
+    void splice(iterator pos, double_list& other) {
+        if (&other == this || other.empty()) return;
+        link_before(pos.current, other.head, other.tail);
+        size_ += other.size_;
+        pool.absorb(other.pool);
+        other.head = other.tail = nullptr;
+        other.size_ = 0;
+    }
+
+    void splice(iterator pos, double_list& other, iterator it) {
+        if (!it.current) throw std::out_of_range("Invalid iterator");
+        splice(pos, other, it, iterator(it.current->nxt), 1);
+    }
+
+    /**
+     * Move the n nodes of [first, last) in front of pos. Within one list
+     * this is an O(1) relink; pos must not be inside (first, last), and
+     * pos == first leaves the list as it is. Only that case and the
+     * whole-list splice relink: nodes of another list live in that list's
+     * pool, which keeps ownership of them, so each is re-created here
+     * from its moved value and erased there, O(n) (never a copy).
+     */
+    void splice(iterator pos, double_list& other, iterator first, iterator last, std::size_t n) {
+        if (first == last || n == 0) return;
+        if (&other != this) {
+            while (n--) {
+                emplace(pos, std::move(*first));
+                first = other.erase(first);
+            }
+            return;
+        }
+        if (pos == last || pos == first) return;  // 已经在 pos 之前, 或 pos 就是区间的首结点
+        Node* f = first.current;
+        Node* l = last.current ? last.current->pre : tail;
+        unlink(f, l);
+        link_before(pos.current, f, l);
+    }
+
     void delete_head() {
         if (!head) {
             return;
@@ -212,7 +587,7 @@ public:
             tail = nullptr;  // 如果是最后一个节点
         }
 
-        delete node_to_delete;  // 释放内存
+        destroy_node(node_to_delete);  // 释放内存
         size_--;  // 更新大小
     }
 
@@ -230,7 +605,7 @@ public:
             head = nullptr;  // 如果是最后一个节点
         }
 
-        delete node_to_delete;  // 释放内存
+        destroy_node(node_to_delete);  // 释放内存
         size_--;  // 更新大小
     }
 
@@ -243,11 +618,15 @@ public:
     }
 
     void clear() {
-        while (head != nullptr) {  // 确保正确迭代
-            Node* temp = head;
-            head = head->nxt;
-            delete temp;  // 删除当前节点
+        if (!std::is_trivially_destructible<T>::value) {
+            while (head != nullptr) {  // 只析构元素, 内存整块归还
+                Node* temp = head;
+                head = head->nxt;
+                temp->~Node();
+            }
         }
+        pool.release();  // 一次性释放所有 slab
+        head = nullptr;
         tail = nullptr;  // 设置尾指针为 nullptr
         size_ = 0;  // 重置大小
     }
@@ -256,732 +635,2405 @@ public:
         if (!head) {
             throw std::out_of_range("List is empty");  // 检查是否为空
         }
-        return *head->data;  // 返回第一个元素
+        return head->data;  // 返回第一个元素
     }
 
     const T& front() const {
         if (!head) {
             throw std::out_of_range("List is empty");  // 检查是否为空
         }
-        return *head->data;  // 返回第一个元素
+        return head->data;  // 返回第一个元素
     }
 
     T& back() {
         if (!tail) {
             throw std::out_of_range("List is empty");  // 检查是否为空
         }
-        return *tail->data;  // 返回最后一个元素
+        return tail->data;  // 返回最后一个元素
     }
 
     const T& back() const {
         if (!tail) {
             throw std::out_of_range("List is empty");  // 检查是否为空
         }
-        return *tail->data;  // 返回最后一个元素
+        return tail->data;  // 返回最后一个元素
     }
 };
 
-template <class T> class deque {
+/**
+ * Counted B+-tree over a sequence of block handles, for deques whose
+ * policy asks for a tree index. Every leaf entry is one block and its
+ * element count; every inner entry caches the element and block totals
+ * of its subtree. That makes the block at an index, the elements in
+ * front of a block, the block holding an element, a count update, and
+ * the insertion or removal of a block all O(kFan * log(blocks)).
+ *
+ * Searches by element never read the count of the last entry of a node
+ * (everything not in front of it lands there), so the count of the last
+ * block may be left stale by its owner.
+ */
+template <class Handle, class Alloc = std::allocator<Handle>>
+class block_tree {
 private:
-  struct Block {
-    double_list<T> items;
-  };
-  double_list<Block> blocks;
-  size_t total_size = 0;
-  size_t block_size = 4; // 
+    static const std::size_t kFan = 32;  // entries per node
+    static const std::size_t kFill = 24;  // entries per node after build(), leaving room to grow
+    static const std::size_t kMaxHeight = 16;
+
+    struct Node;
+    struct Entry {
+        std::size_t sum;  // elements below
+        std::size_t blocks;  // leaves below (1 for a leaf entry)
+        Node *child;  // null in a leaf
+        Handle handle;
+    };
+    struct Node {
+        std::size_t n;
+        Entry e[kFan + 1];  // one spare, so that an insert can overflow before the split
+    };
 
-  void Balance() {
-    if (blocks.empty()) return;
+    node_pool<Node, Alloc> pool;
+    Node *root = nullptr;
+    std::size_t height = 0;  // inner levels above the leaves
+    std::size_t size_ = 0;
 
-    size_t new_block_size = std::sqrt(total_size) + 1;
-    if (new_block_size != block_size) {
-      block_size = new_block_size;
-      
-      auto it = blocks.begin();
-      while (it != blocks.end()) {
-        if (it->items.size() > block_size * 2) {
-          Split(it);
+    Node *NewNode() {
+        Node *node = new (pool.allocate()) Node;
+        node->n = 0;
+        return node;
+    }
+
+    static Entry Summary(Node *node) {
+        Entry s{0, 0, node, Handle()};
+        for (std::size_t i = 0; i < node->n; ++i) {
+            s.sum += node->e[i].sum;
+            s.blocks += node->e[i].blocks;
+        }
+        return s;
+    }
+
+    static void Place(Node *node, std::size_t i, const Entry &entry) {
+        for (std::size_t j = node->n; j > i; --j) node->e[j] = node->e[j - 1];
+        node->e[i] = entry;
+        ++node->n;
+    }
+
+    static void Remove(Node *node, std::size_t i) {
+        for (std::size_t j = i + 1; j < node->n; ++j) node->e[j - 1] = node->e[j];
+        --node->n;
+    }
+
+    // the entry of node whose subtree holds block bi, which is made relative to it
+    static std::size_t Child(const Node *node, std::size_t &bi) {
+        std::size_t j = 0;
+        while (bi >= node->e[j].blocks) bi -= node->e[j++].blocks;
+        return j;
+    }
+
+    Entry &Leaf(std::size_t bi) const {
+        Node *node = root;
+        for (std::size_t h = height; h > 0; --h) node = node->e[Child(node, bi)].child;
+        return node->e[bi];
+    }
+
+    // insert entry as block bi below node (at height h); returns the new right half if node split
+    Node *Insert(Node *node, std::size_t h, std::size_t bi, const Entry &entry) {
+        if (h == 0) {
+            Place(node, bi, entry);
+        } else {
+            std::size_t j = 0;
+            while (j + 1 < node->n && bi > node->e[j].blocks) bi -= node->e[j++].blocks;
+            Node *right = Insert(node->e[j].child, h - 1, bi, entry);
+            node->e[j].sum += entry.sum;
+            node->e[j].blocks += 1;
+            if (right) {
+                Entry s = Summary(right);
+                node->e[j].sum -= s.sum;
+                node->e[j].blocks -= s.blocks;
+                Place(node, j + 1, s);
+            }
         }
-        else if ((it->items.size()) * 2 < block_size) {
-          Merge(it);
+        if (node->n <= kFan) return nullptr;
+        Node *right = NewNode();
+        std::size_t keep = node->n / 2;
+        for (std::size_t i = keep; i < node->n; ++i) right->e[right->n++] = node->e[i];
+        node->n = keep;
+        return right;
+    }
+
+    // remove block bi below node (at height h); returns its element count
+    std::size_t Erase(Node *node, std::size_t h, std::size_t bi) {
+        if (h == 0) {
+            std::size_t sum = node->e[bi].sum;
+            Remove(node, bi);
+            return sum;
+        }
+        std::size_t j = Child(node, bi);
+        Node *child = node->e[j].child;
+        std::size_t sum = Erase(child, h - 1, bi);
+        node->e[j].sum -= sum;
+        node->e[j].blocks -= 1;
+        if (child->n == 0) {
+            pool.deallocate(child);
+            Remove(node, j);
+        } else if (child->n < kFan / 4 && node->n > 1) {  // fold an underfull child into a neighbour
+            std::size_t l = j + 1 < node->n ? j : j - 1;
+            Node *a = node->e[l].child, *b = node->e[l + 1].child;
+            if (a->n + b->n <= kFill) {
+                for (std::size_t i = 0; i < b->n; ++i) a->e[a->n++] = b->e[i];
+                node->e[l].sum += node->e[l + 1].sum;
+                node->e[l].blocks += node->e[l + 1].blocks;
+                pool.deallocate(b);
+                Remove(node, l + 1);
+            }
+        }
+        return sum;
+    }
+
+    // bulk loading: append entry to the open node of level, closing full nodes upwards
+    void Push(Node **open, std::size_t &top, std::size_t level, const Entry &entry) {
+        if (!open[level]) open[level] = NewNode();
+        if (level > top) top = level;
+        Node *node = open[level];
+        node->e[node->n++] = entry;
+        if (node->n == kFill) {
+            open[level] = nullptr;
+            Push(open, top, level + 1, Summary(node));
         }
-        ++it;
-      }
     }
-  }
 
-  void Merge(typename double_list<Block>::iterator it) {
-    if (it == blocks.end()) return;
-    auto& current_block = *it;
-    ++it;
-    if (it == blocks.end()) return;
-    auto& next_block = *it;
-    
-    if (current_block.items.size() + next_block.items.size() <= block_size) {
-      auto next_it = next_block.items.begin();
-      while (next_it != next_block.items.end()) {
-        current_block.items.insert_tail(*next_it);
-        ++next_it;
-      }
-      blocks.erase(it);
+public:
+    block_tree() {}
+    block_tree(const block_tree &) = delete;
+    block_tree &operator=(const block_tree &) = delete;
+
+    std::size_t size() const { return size_; }
+    std::size_t depth() const { return root ? height + 1 : 0; }  // nodes on a root-to-leaf path
+
+    Handle at(std::size_t bi) const { return Leaf(bi).handle; }
+    std::size_t count(std::size_t bi) const { return Leaf(bi).sum; }
+
+    // elements in front of block bi
+    std::size_t prefix(std::size_t bi) const {
+        std::size_t before = 0;
+        const Node *node = root;
+        for (std::size_t h = height; h > 0; --h) {
+            std::size_t j = 0;
+            for (; bi >= node->e[j].blocks; ++j) {
+                bi -= node->e[j].blocks;
+                before += node->e[j].sum;
+            }
+            node = node->e[j].child;
+        }
+        for (std::size_t j = 0; j < bi; ++j) before += node->e[j].sum;
+        return before;
+    }
+
+    /**
+     * the block holding element key (the last one if key is past the end),
+     * its index bi and the elements before it, taking the first block to
+     * hold lag fewer elements than its count says
+     */
+    Handle find(std::size_t key, std::size_t lag, std::size_t &bi, std::size_t &before) const {
+        bi = before = 0;
+        const Node *node = root;
+        for (std::size_t h = height + 1; h > 0; --h) {
+            std::size_t j = 0;
+            for (; j + 1 < node->n; ++j) {
+                std::size_t sum = node->e[j].sum - (j == 0 ? lag : 0);
+                if (key < sum) break;
+                key -= sum;
+                before += sum;
+                bi += node->e[j].blocks;
+            }
+            if (j > 0) lag = 0;  // off the leftmost path
+            if (h == 1) return node->e[j].handle;
+            node = node->e[j].child;
+        }
+        return Handle();
+    }
+
+    // add d (two's complement for a decrease) to the count of block bi
+    void add(std::size_t bi, std::size_t d) {
+        Node *node = root;
+        for (std::size_t h = height; h > 0; --h) {
+            std::size_t j = Child(node, bi);
+            node->e[j].sum += d;
+            node = node->e[j].child;
+        }
+        node->e[bi].sum += d;
+    }
+
+    void set(std::size_t bi, std::size_t count) { add(bi, count - this->count(bi)); }
+
+    // block bi is now handle, holding count elements
+    void reset(std::size_t bi, Handle handle, std::size_t count) {
+        Leaf(bi).handle = handle;
+        set(bi, count);
+    }
+
+    // a new block bi (0 <= bi <= size()) in front of the current one
+    void insert(std::size_t bi, Handle handle, std::size_t count) {
+        Entry entry{count, 1, nullptr, handle};
+        ++size_;
+        if (!root) {
+            root = NewNode();
+            Place(root, 0, entry);
+            return;
+        }
+        if (Node *right = Insert(root, height, bi, entry)) {
+            Node *top = NewNode();
+            top->e[0] = Summary(root);
+            top->e[1] = Summary(right);
+            top->n = 2;
+            root = top;
+            ++height;
+        }
     }
-  }
 
-  void Split(typename double_list<Block>::iterator it) {
-    if (it->items.size() <= block_size) return;
+    void erase(std::size_t bi) {
+        --size_;
+        Erase(root, height, bi);
+        while (height > 0 && root->n == 1) {
+            Node *child = root->e[0].child;
+            pool.deallocate(root);
+            root = child;
+            --height;
+        }
+        if (root->n == 0) clear();
+    }
+
+    // rebuild from the blocks [first, last) in O(blocks); It derefs to something with a count
+    template <class It>
+    void build(It first, It last) {
+        clear();
+        Node *open[kMaxHeight + 1] = {};
+        std::size_t top = 0;
+        for (; first != last; ++first, ++size_) Push(open, top, 0, Entry{first->count, 1, nullptr, first});
+        if (size_ == 0) return;
+        for (std::size_t level = 0; level < top; ++level)
+            if (open[level]) {
+                Node *node = open[level];
+                open[level] = nullptr;
+                Push(open, top, level + 1, Summary(node));
+            }
+        root = open[top];
+        height = top;
+        while (height > 0 && root->n == 1) {
+            Node *child = root->e[0].child;
+            pool.deallocate(root);
+            root = child;
+            --height;
+        }
+    }
 
-    Block new_block;
-    auto split_it = it->items.begin();
-    std::advance(split_it, it->items.size() / 2);
+    void clear() {
+        pool.release();  // nodes are trivially destructible
+        root = nullptr;
+        height = size_ = 0;
+    }
 
-    // Move half of the items to the new block
-    while (split_it != it->items.end()) {
-        new_block.items.insert_tail(*split_it);
-        split_it = it->items.erase(split_it);
+    void swap(block_tree &other) noexcept {
+        pool.swap(other.pool);
+        std::swap(root, other.root);
+        std::swap(height, other.height);
+        std::swap(size_, other.size_);
     }
 
-    ++it;
-    if(it != blocks.end()) blocks.insert(it, new_block);
-    else blocks.insert_tail(new_block);
+    std::size_t bytes() const { return pool.bytes(); }
+    std::size_t allocations() const { return pool.allocations(); }
+};
+
+namespace detail {
+template <class...> struct make_void { typedef void type; };
+
+// compile-time block capacity a policy asks for, or 0 for a runtime one
+template <class Policy, class T, class = void>
+struct fixed_capacity : std::integral_constant<std::size_t, 0> {};
+template <class Policy, class T>
+struct fixed_capacity<Policy, T, typename make_void<typename Policy::template capacity<T>>::type>
+    : std::integral_constant<std::size_t, Policy::template capacity<T>::value> {};
+
+// whether a policy asks for the block_tree index instead of the flat directory
+template <class Policy, class = void>
+struct tree_index : std::false_type {};
+template <class Policy>
+struct tree_index<Policy, typename std::enable_if<Policy::tree_index>::type> : std::true_type {};
+
+// largest power of two <= n, for n >= 1
+constexpr std::size_t floor_pow2(std::size_t n, std::size_t p = 1) {
+  return p * 2 > n || p * 2 == 0 ? p : floor_pow2(n, p * 2);
+}
+
+// iterator_category of It, or input_iterator_tag when It declares none
+template <class It, class = void>
+struct iterator_category { typedef std::input_iterator_tag type; };
+template <class It>
+struct iterator_category<It, typename make_void<typename std::iterator_traits<It>::iterator_category>::type> {
+  typedef typename std::iterator_traits<It>::iterator_category type;
+};
+} // namespace detail
+
+/**
+ * Block-size policies for deque. block_size(n, current) returns the target
+ * block size for n elements given the current one; when it changes, the
+ * deque re-fixes its blocks incrementally, at most fixes_per_op blocks per
+ * modifying call, instead of sweeping the whole chain at once.
+ */
+
+// the original rule: block_size tracks sqrt(n) + 1 exactly
+struct sqrt_balance {
+  static const std::size_t fixes_per_op = 4;
+  static std::size_t block_size(std::size_t n, std::size_t) {
+    return static_cast<std::size_t>(std::sqrt(n)) + 1;
+  }
+};
+
+/**
+ * block_size is a power of two kept within [sqrt(n / 2), 2 * sqrt(n)]:
+ * it doubles once n reaches 2 * b^2 and halves once n drops below b^2 / 4,
+ * so n has to change by a factor of two before the blocks are re-fixed
+ * again, and oscillating around a threshold costs nothing.
+ */
+struct pow2_balance {
+  static const std::size_t fixes_per_op = 4;
+  static const std::size_t min_block = 4;
+  static std::size_t block_size(std::size_t n, std::size_t b) {
+    if (b < min_block) b = min_block;
+    while (n / b >= 2 * b) b *= 2;
+    while (b > min_block && n < b / 4 * b) b /= 2;
+    return b;
+  }
+};
+
+/**
+ * Compile-time block capacity. Every block is a ring of exactly Capacity
+ * slots, so the ring mask is a constant and all buffers are the same size.
+ * block_size stays at Capacity / 2: blocks only merge with underfull
+ * neighbours, and split where an insert meets a full one. Suits scans
+ * and end operations; for middle-insert-heavy workloads the sqrt-sized
+ * policies above keep inserts at O(sqrt(n)), and tree_blocks below at
+ * O(log(n)).
+ */
+template <std::size_t Capacity>
+struct fixed_block {
+  static_assert(Capacity >= 8 && (Capacity & (Capacity - 1)) == 0, "fixed_block capacity must be a power of two >= 8");
+  static const std::size_t fixes_per_op = 4;
+  template <class T> struct capacity : std::integral_constant<std::size_t, Capacity> {};
+  static std::size_t block_size(std::size_t, std::size_t b) { return b; }
+};
+
+// fixed_block sized by a byte budget: as many T per block as fit in Bytes (at least 8)
+template <std::size_t Bytes = 4096>
+struct fixed_bytes {
+  static const std::size_t fixes_per_op = 4;
+  template <class T>
+  struct capacity
+      : std::integral_constant<std::size_t, Bytes / sizeof(T) < 8 ? 8 : detail::floor_pow2(Bytes / sizeof(T))> {};
+  static std::size_t block_size(std::size_t, std::size_t b) { return b; }
+};
+
+/**
+ * fixed_bytes blocks indexed by a counted B+-tree (block_tree) instead of
+ * the flat directory. A middle insert or erase then moves at most half a
+ * block and updates O(log(blocks)) tree nodes, and a split or merge of a
+ * block is one tree insert or erase, where the directory has to shift
+ * later block starts and be rebuilt; indexing stays O(log(blocks)).
+ * Pushes and pops at either end touch the tree only when a block is
+ * added or dropped. Bulk operations (range insert and erase, append,
+ * split_at, copies) rebuild the tree in O(blocks). For very large deques
+ * with many middle edits; the flat directory is faster for the rest.
+ */
+template <std::size_t Bytes = 4096>
+struct tree_blocks {
+  static const std::size_t fixes_per_op = 4;
+  static const bool tree_index = true;
+  template <class T> struct capacity : fixed_bytes<Bytes>::template capacity<T> {};
+  static std::size_t block_size(std::size_t, std::size_t b) { return b; }
+};
+
+/**
+ * Binary serialization. deque::serialize(write) hands the whole deque to
+ * write(const deque_span *spans, size_t n): a deque_wire_header, then
+ * the elements. For trivially copyable T every element span is a piece
+ * of block storage itself (at most two per block), ready for writev.
+ * deque::deserialize(read) takes it back through read(void *dest, size_t
+ * bytes), which must fill all of dest or throw; trivially copyable
+ * elements are read straight into new blocks. Byte order and layout are
+ * the host's.
+ *
+ * Other element types go through deque_serial<T>, which has to be
+ * specialized with
+ *   template <class Writer> static void write(const T &value, Writer &write);
+ *   template <class Reader> static T read(Reader &read);
+ * each element's bytes then follow the header in whatever form write
+ * chose.
+ */
+struct deque_span {  // the layout of struct iovec
+  const void *data;
+  std::size_t size;
+};
+
+struct deque_wire_header {
+  static const std::uint64_t kMagic = 0x3130514544554a53ull;  // "SJUDEQ01"
+  std::uint64_t magic;
+  std::uint64_t element_size;  // sizeof(T)
+  std::uint64_t raw;           // 1 when the elements are raw bytes, 0 when deque_serial wrote them
+  std::uint64_t count;
+};
+
+template <class T>
+struct deque_serial;
+
+/**
+ * A buffer handed over to deque's adopting constructor: data holds
+ * capacity elements' worth of storage from the deque's Alloc, and
+ * data[0, count) are constructed elements.
+ */
+template <class T>
+struct deque_buffer {
+  T *data;
+  std::size_t capacity;
+  std::size_t count;
+};
+
+// selects the adopting constructor
+struct adopt_buffers_t {};
+
+/**
+ * What deque::memory_stats() reports. bytes_allocated is everything the
+ * deque currently holds from its allocator: block buffers, cached spare
+ * buffers, the block list's node slabs and the block directory (or tree
+ * index). A buffer shared with a copy-on-write copy is counted by every
+ * copy holding it.
+ * The counters run from construction (or the last assignment) on.
+ */
+struct deque_memory_stats {
+  std::size_t bytes_allocated = 0;
+  std::size_t element_bytes = 0;   // size() * sizeof(T)
+  std::size_t blocks = 0;
+  std::size_t min_fill = 0;        // elements in the emptiest block
+  std::size_t max_fill = 0;        // elements in the fullest block
+  double avg_fill = 0;             // elements / slots over all blocks, 0 to 1
+  std::size_t block_size = 0;      // the current target
+  std::size_t allocations = 0;     // calls that reached the allocator
+  std::size_t rebalances = 0;      // blocks split or merged to keep sizes in range
+  std::size_t resizes = 0;         // block_size changes, each restarting Balance()'s sweep
+};
+
+#if SJTU_DEQUE_PROFILE
+/**
+ * What deque::profile() reports (only with SJTU_DEQUE_PROFILE). Every
+ * series keeps a count, a sum, a maximum and a log2 histogram: bucket b
+ * counts the values v with bit width b, i.e. 2^(b-1) <= v < 2^b, and
+ * v = 0 lands in bucket 0.
+ *
+ * The timings are in nanoseconds and inclusive (balance contains the
+ * split, merge and reindex calls it makes). balance only counts the
+ * calls that had blocks to fix, split and merge only the ones that
+ * relinked the chain. The walks count directory entries: the probes of
+ * at()'s binary search, and the entries a single-element insert / erase
+ * shifts (or rebuilds, when it relinked the chain).
+ *
+ * A hook set with deque_profile::set_hook sees every value as it is
+ * recorded, from every deque in the process, e.g. to feed a metrics
+ * pipeline; it must be cheap and must not touch the deque.
+ */
+struct deque_profile {
+  static const std::size_t kBuckets = 40;  // the last bucket takes everything larger
+
+  struct series {
+    std::uint64_t count = 0;
+    std::uint64_t total = 0;
+    std::uint64_t max = 0;
+    std::uint64_t histogram[kBuckets] = {};
+
+    void record(std::uint64_t v) {
+      ++count;
+      total += v;
+      if (v > max) max = v;
+      std::size_t b = 0;
+      while (b + 1 < kBuckets && (v >> b) != 0) ++b;
+      ++histogram[b];
+    }
+    double mean() const { return count ? static_cast<double>(total) / count : 0; }
+  };
+
+  series balance, split, merge, reindex;  // ns per call
+  series at_walk, insert_walk, erase_walk;  // directory entries per call
+
+  typedef void (*hook_type)(const char *name, std::uint64_t value, void *context);
+  static void set_hook(hook_type hook, void *context = nullptr) {
+    hook_slot().hook = hook;
+    hook_slot().context = context;
+  }
+
+  // record v in s and pass it to the hook under name
+  static void report(series &s, const char *name, std::uint64_t v) {
+    s.record(v);
+    const slot &h = hook_slot();
+    if (h.hook) h.hook(name, v, h.context);
+  }
+
+private:
+  struct slot {
+    hook_type hook = nullptr;
+    void *context = nullptr;
+  };
+  static slot &hook_slot() {
+    static slot s;
+    return s;
   }
+};
 
+namespace detail {
+// times the enclosing scope into one series of a deque_profile
+class profile_timer {
 public:
-  class const_iterator;
-  class iterator {
-  public:
-    typename double_list<T>::iterator item_it;
-    typename double_list<Block>::iterator block_it;
-    deque *outer;
+  profile_timer(deque_profile::series &s, const char *n)
+    : target(s), name(n), start(std::chrono::steady_clock::now()) {}
+  ~profile_timer() {
+    std::chrono::nanoseconds ns = std::chrono::steady_clock::now() - start;
+    deque_profile::report(target, name, static_cast<std::uint64_t>(ns.count()));
+  }
+  profile_timer(const profile_timer &) = delete;
+  profile_timer &operator=(const profile_timer &) = delete;
+
+private:
+  deque_profile::series &target;
+  const char *name;
+  std::chrono::steady_clock::time_point start;
+};
+} // namespace detail
 
-    iterator() : item_it(), block_it(), outer(nullptr) {}
+#define SJTU_DEQUE_TIME(field) ::sjtu::detail::profile_timer sjtu_deque_timer_(profile_.field, #field)
+#define SJTU_DEQUE_WALK(field, n) ::sjtu::deque_profile::report(profile_.field, #field, (n))
+#else
+#define SJTU_DEQUE_TIME(field) ((void)0)
+#define SJTU_DEQUE_WALK(field, n) ((void)0)
+#endif
 
-    iterator(const iterator& other) 
-      : item_it(other.item_it), block_it(other.block_it), outer(other.outer) {}
+template <class T, class Alloc = std::allocator<T>, class Policy = pow2_balance> class deque {
+private:
+  typedef buffer_pool<T, Alloc> block_pool;
 
-    iterator(typename double_list<T>::iterator i_it, typename double_list<Block>::iterator b_it, deque *out):
-      item_it(i_it), block_it(b_it), outer(out){}
+  // non-zero when Policy fixes the block capacity at compile time
+  static const size_t kFixedCap = detail::fixed_capacity<Policy, T>::value;
+  // blocks are indexed by a block_tree rather than the flat directory
+  static const bool kTree = detail::tree_index<Policy>::value;
+  static const size_t kInitialBlockSize = kFixedCap ? kFixedCap / 2 : 4;
+  static_assert(kFixedCap == 0 || kFixedCap * sizeof(T) >= block_pool::min_bytes,
+                "fixed block capacity is too small for the buffer pool");
 
-    iterator& operator=(const iterator& other) {
-      if (this != &other) {
-        item_it = other.item_it;
-        block_it = other.block_it;
-        outer = other.outer;
+  /**
+   * A block is one fixed-capacity circular buffer of raw T storage.
+   * cap is always a power of two, so the physical slot of the i-th
+   * element is (head + i) & mask(). Buffers come from (and go back
+   * to) the owning deque's buffer pool. With a fixed-capacity policy,
+   * width() and mask() are compile-time constants.
+   *
+   * In copy-on-write mode several blocks (of different deques) may share
+   * one buffer, counted by refs. Every mutating member, including the
+   * non-const operator[], first calls own() to get a private copy; the
+   * last block to let go of a shared buffer destroys and frees it.
+   *
+   * For trivially copyable T every bulk move (copy, own, shifts inside
+   * emplace/erase, and the hand-overs behind Split/Merge) is done with
+   * at most a few memcpy/memmove calls per ring piece instead of one
+   * constructor call per element.
+   */
+  struct Block {
+    static constexpr bool raw = std::is_trivially_copyable<T>::value;
+
+    block_pool *pool;
+    T *data;
+    size_t cap;
+    size_t head;
+    size_t count;
+    mutable size_t *refs = nullptr;  // null while the buffer is not shared
+
+    struct share_tag {};
+
+    Block(block_pool *p, size_t capacity)
+      : pool(p), data(p->allocate(capacity)), cap(capacity), head(0), count(0) {}
+
+    // deep copy into a buffer from p, laid out from slot 0
+    Block(const Block &other, block_pool *p) : Block(p, other.cap) {
+      if (raw) {
+        other.copy_to(data);
+        count = other.count;
+        return;
       }
+      for (; count < other.count; ++count) new (data + count) T(other[count]);
+    }
+
+    Block(const Block &other) : Block(other, other.pool) {}
+
+    // a second handle on other's buffer, owned through p from now on
+    Block(const Block &other, block_pool *p, share_tag)
+      : pool(p), data(other.data), cap(other.cap), head(other.head), count(other.count) {
+      if (!other.refs) other.refs = new size_t(1);
+      refs = other.refs;
+      ++*refs;
+    }
+
+    struct adopt_tag {};
+
+    // take over a buffer from p's allocator whose first n slots hold elements
+    Block(block_pool *p, T *d, size_t capacity, size_t n, adopt_tag)
+      : pool(p), data(d), cap(capacity), head(0), count(n) {}
+
+    Block(Block &&other) noexcept
+      : pool(other.pool), data(other.data), cap(other.cap), head(other.head), count(other.count),
+        refs(other.refs) {
+      other.data = nullptr;
+      other.cap = other.head = other.count = 0;
+      other.refs = nullptr;
+    }
+
+    Block &operator=(const Block &other) {
+      if (this == &other) return *this;
+      Block tmp(other);
+      swap(tmp);
       return *this;
     }
-    /**
-     * return a new iterator which points to the n-next element.
-     * if there are not enough elements, the behaviour is undefined.
-     * same for operator-.
-     */
-    iterator operator+(const int &n) const {
-      if(n<0) return *this - (-n);
 
-      iterator temp = *this;
-      if (n == 0) return temp;
-      if(temp.block_it == nullptr) throw std::out_of_range("");
+    Block &operator=(Block &&other) noexcept {
+      swap(other);
+      return *this;
+    }
 
-      int remain = n;
-      int block_remaining = std::distance(temp.item_it, temp.block_it->items.end());
-      if(remain<block_remaining) {
-        std::advance(temp.item_it, remain);
-        return temp;
+    ~Block() {
+      if (refs && *refs > 1) {  // another copy still reads the buffer
+        --*refs;
+        return;
       }
-
-      remain -= block_remaining;
-      if(!remain && temp.block_it == outer->blocks.get_tail())
-        return outer->end();
-      
-      ++temp.block_it;
-      if(temp.block_it == outer->blocks.end()) throw std::out_of_range("");
-      temp.item_it = temp.block_it->items.begin();
-      while (remain > 0) {       
-        if (remain < temp.block_it->items.size())
-          break;
-        else {
-          remain -= temp.block_it->items.size();   
-          if (temp.block_it != outer->blocks.get_tail()) {
-            ++temp.block_it;
-            temp.item_it = temp.block_it->items.begin();
-          }
-          else {
-            if(remain)
-              throw std::out_of_range("");
-            else temp.item_it = temp.block_it->items.end();
-          }
+      delete refs;
+      refs = nullptr;
+      clear();
+      if (data) pool->deallocate(data, cap);
+    }
+
+    void swap(Block &other) noexcept {
+      std::swap(pool, other.pool);
+      std::swap(data, other.data);
+      std::swap(cap, other.cap);
+      std::swap(head, other.head);
+      std::swap(count, other.count);
+      std::swap(refs, other.refs);
+    }
+
+    // make the buffer private before a write
+    void own() {
+      if (!refs) return;
+      if (*refs > 1) {
+        T *fresh = pool->allocate(cap);
+        size_t n = 0;
+        if (raw) {
+          copy_to(fresh);
+          n = count;
         }
+        try {
+          for (; n < count; ++n) new (fresh + n) T(*slot(head + n));
+        } catch (...) {
+          while (n) fresh[--n].~T();
+          pool->deallocate(fresh, cap);
+          throw;
+        }
+        --*refs;
+        refs = nullptr;
+        data = fresh;
+        head = 0;
+        return;
       }
-
-      std::advance(temp.item_it, remain);
-      return temp;
+      delete refs;
+      refs = nullptr;
     }
-    // additional iterator operations
 
-    iterator operator-(const int &n) const {
-      if(n<0) return *this + (-n);
+    size_t width() const { return kFixedCap ? kFixedCap : cap; }
+    size_t mask() const { return width() - 1; }
 
-      iterator temp = *this; 
-      if (n == 0) return temp;
+    T *slot(size_t phys) const { return data + (phys & mask()); }
 
-      int remain = n;
-      if(temp == outer->end()) {
-        temp.block_it = outer->blocks.get_tail();
-        temp.item_it = temp.block_it->items.get_tail();
-        --remain;
-      }
+    // length of the contiguous run starting at logical index i, at most n
+    size_t run(size_t i, size_t n) const {
+      size_t left = width() - ((head + i) & mask());
+      return left < n ? left : n;
+    }
 
-      int block_remaining = std::distance(temp.block_it->items.begin(),temp.item_it);
-      if(remain<=block_remaining){
-        while(remain--)
-          --temp.item_it;
-        return temp;
-      }
-      if(temp.block_it==outer->blocks.begin()) throw std::out_of_range("");
-      remain-=block_remaining;
-      --remain;
-      --temp.block_it;
-      temp.item_it = temp.block_it->items.get_tail();
-
-      while (remain > 0) {
-        if(remain<temp.block_it->items.size())
-          break;
-           
-        if(temp.block_it==outer->blocks.begin()) throw std::out_of_range("");
-        remain-=temp.block_it->items.size();
-        --temp.block_it;
-        temp.item_it = temp.block_it->items.get_tail();
-      } 
-
-      while(remain--){
-        --temp.item_it;
-      }
-      return temp;
+    // raw byte copy of all elements to dest, laid out from dest[0] (raw only)
+    void copy_to(T *dest) const {
+      size_t first = run(0, count);
+      std::memcpy(static_cast<void *>(dest), slot(head), first * sizeof(T));
+      std::memcpy(static_cast<void *>(dest + first), data, (count - first) * sizeof(T));
     }
 
-    /**
-     * return the distance between two iterators.
-     * if they point to different vectors, throw
-     * invaild_iterator.
-     */
-    size_t operator-(const iterator& rhs) const {
-      if (block_it==nullptr || rhs.block_it==nullptr)
-        throw std::out_of_range("");       
-
-      size_t distance = 0;
-      auto temp_block_it = rhs.block_it;
-      auto temp_item_it = rhs.item_it;     
-
-      if (block_it == rhs.block_it) {
-        bool f=0;
-        while(temp_item_it!=item_it){
-          if(temp_item_it == temp_block_it->items.end()){
-            f=1;
-            break;
-          }
-          distance++;
-          ++temp_item_it;
-        }
-        if(f) return -std::distance(item_it, rhs.item_it);
-        else return distance;
-      }
+    // raw copy of src[0, n) behind the last element (raw only)
+    void append_raw(const T *src, size_t n) {
+      size_t first = run(count, n);
+      std::memcpy(static_cast<void *>(slot(head + count)), src, first * sizeof(T));
+      std::memcpy(static_cast<void *>(data), src + first, (n - first) * sizeof(T));
+      count += n;
+    }
 
-      distance += std::distance(temp_item_it, temp_block_it->items.end());
-      ++temp_block_it;
-      
-      bool f=1;
-      while (temp_block_it != block_it) {
-        if(temp_block_it == rhs.outer->blocks.end()){
-          f=0;
-          break;
-        }        
-        distance += temp_block_it->items.size();
-        ++temp_block_it;
-      }
-      if(f) {
-        temp_item_it = temp_block_it->items.begin();       
-        distance += std::distance(temp_item_it, item_it);
-        return distance;
-      }
+    // raw copy of src[0, n) in front of the first element (raw only)
+    void prepend_raw(const T *src, size_t n) {
+      head = (head - n) & mask();
+      count += n;
+      size_t first = run(0, n);
+      std::memcpy(static_cast<void *>(slot(head)), src, first * sizeof(T));
+      std::memcpy(static_cast<void *>(data), src + first, (n - first) * sizeof(T));
+    }
 
-      distance = 0;
-      temp_block_it = block_it;
-      temp_item_it = item_it;  
-      distance += std::distance(temp_item_it, temp_block_it->items.end());
-      ++temp_block_it;
-      
-      f=1;
-      while (temp_block_it != rhs.block_it) {
-        if(temp_block_it == outer->blocks.end()){
-          f=0;
-          break;
-        }        
-        distance += temp_block_it->items.size();
-        ++temp_block_it;
+    // memmove logical [from, from + n) to [to, to + n), one call per ring piece (raw only)
+    void shift_raw(size_t from, size_t to, size_t n) {
+      if (to < from) {
+        for (size_t k = 0; k < n;) {
+          size_t len = run(to + k, run(from + k, n - k));
+          std::memmove(static_cast<void *>(slot(head + to + k)), slot(head + from + k), len * sizeof(T));
+          k += len;
+        }
+        return;
       }
-      if(f) {
-        temp_item_it = temp_block_it->items.begin();       
-        distance += std::distance(temp_item_it, rhs.item_it);
-        return -distance;
+      for (size_t k = n; k > 0;) {  // back to front, pieces end at the last unmoved slot
+        size_t s = (head + from + k - 1) & mask(), d = (head + to + k - 1) & mask();
+        size_t len = k;
+        if (s + 1 < len) len = s + 1;
+        if (d + 1 < len) len = d + 1;
+        std::memmove(static_cast<void *>(data + d + 1 - len), data + s + 1 - len, len * sizeof(T));
+        k -= len;
       }
-      else  throw std::out_of_range("");
     }
 
-    iterator operator+=(const int &n) {
-      *this = *this + n;
-      return *this;
+    T &operator[](size_t i) {
+      if (refs) own();
+      return *slot(head + i);
     }
+    const T &operator[](size_t i) const { return *slot(head + i); }
 
-    iterator operator-=(const int &n) {
+    bool full() const { return count == width(); }
+
+    template <class... Args>
+    void emplace_back(Args &&...args) {
+      if (refs) own();
+      new (slot(head + count)) T(std::forward<Args>(args)...);
+      ++count;
+    }
+
+    template <class... Args>
+    void emplace_front(Args &&...args) {
+      if (refs) own();
+      new (slot(head - 1)) T(std::forward<Args>(args)...);
+      head = (head - 1) & mask();
+      ++count;
+    }
+
+    void pop_back() {
+      if (refs) own();
+      slot(head + count - 1)->~T();
+      --count;
+    }
+
+    void pop_front() {
+      if (refs) own();
+      slot(head)->~T();
+      head = (head + 1) & mask();
+      --count;
+    }
+
+    // insert before the i-th element, shifting whichever side is shorter
+    template <class... Args>
+    void emplace(size_t i, Args &&...args) {
+      if (i == 0) { emplace_front(std::forward<Args>(args)...); return; }
+      if (i == count) { emplace_back(std::forward<Args>(args)...); return; }
+      T tmp(std::forward<Args>(args)...);  // args may alias an element of this block
+      if (raw) {
+        if (refs) own();
+        if (i < count / 2) {
+          head = (head - 1) & mask();
+          ++count;
+          shift_raw(1, 0, i);
+        } else {
+          shift_raw(i, i + 1, count - i);
+          ++count;
+        }
+        new (slot(head + i)) T(std::move(tmp));
+        return;
+      }
+      if (i < count / 2) {
+        emplace_front(std::move((*this)[0]));
+        for (size_t j = 1; j < i; ++j) (*this)[j] = std::move((*this)[j + 1]);
+      } else {
+        emplace_back(std::move((*this)[count - 1]));
+        for (size_t j = count - 2; j > i; --j) (*this)[j] = std::move((*this)[j - 1]);
+      }
+      (*this)[i] = std::move(tmp);
+    }
+
+    // remove elements [i, i + n), closing the gap from whichever side is shorter
+    void erase(size_t i, size_t n = 1) {
+      if (raw) {  // trivially copyable implies trivially destructible
+        if (refs) own();
+        if (i < count - i - n) {
+          shift_raw(0, n, i);
+          head = (head + n) & mask();
+        } else {
+          shift_raw(i + n, i, count - i - n);
+        }
+        count -= n;
+        return;
+      }
+      if (i < count - i - n) {
+        for (size_t j = i; j-- > 0;) (*this)[j + n] = std::move((*this)[j]);
+        for (size_t k = 0; k < n; ++k) pop_front();
+      } else {
+        for (size_t j = i + n; j < count; ++j) (*this)[j - n] = std::move((*this)[j]);
+        for (size_t k = 0; k < n; ++k) pop_back();
+      }
+    }
+
+    // relocate the last n elements, in order, to the back of dest
+    void move_back_to(Block &dest, size_t n) {
+      if (raw) {  // only count changes here, so a shared source needs no own()
+        if (dest.refs) dest.own();
+        size_t first = run(count - n, n);
+        dest.append_raw(slot(head + count - n), first);
+        dest.append_raw(data, n - first);
+        count -= n;
+        return;
+      }
+      for (size_t i = count - n; i < count; ++i) dest.emplace_back(std::move((*this)[i]));
+      while (n--) pop_back();
+    }
+
+    // relocate the first n elements, in order, to the front of dest
+    void move_front_to(Block &dest, size_t n) {
+      if (raw) {
+        if (dest.refs) dest.own();
+        size_t first = run(0, n);
+        dest.prepend_raw(data, n - first);
+        dest.prepend_raw(slot(head), first);
+        head = (head + n) & mask();
+        count -= n;
+        return;
+      }
+      for (size_t i = n; i-- > 0;) dest.emplace_front(std::move((*this)[i]));
+      while (n--) pop_front();
+    }
+
+    // grow the buffer in place; elements are re-laid out from slot 0
+    void reserve(size_t capacity) {
+      if (capacity <= cap) return;
+      Block bigger(pool, capacity);
+      move_back_to(bigger, count);
+      swap(bigger);
+    }
+
+    // the same, to a smaller buffer that still holds every element
+    void shrink(size_t capacity) {
+      if (capacity >= cap || capacity < count) return;
+      Block smaller(pool, capacity);
+      move_back_to(smaller, count);
+      swap(smaller);
+    }
+
+    void clear() {
+      if (refs && *refs > 1) {  // leave the shared elements to the other copies
+        --*refs;
+        refs = nullptr;
+        data = pool->allocate(cap);
+        head = count = 0;
+        return;
+      }
+      if (std::is_trivially_destructible<T>::value) count = 0;
+      while (count) pop_back();
+      head = 0;
+    }
+  };
+
+  // smallest power of two >= n that the buffer pool can hold (the fixed capacity, if any)
+  static size_t RoundUp(size_t n) {
+    if (kFixedCap) return kFixedCap;  // callers never ask for more than one fixed block holds
+    size_t cap = 1;
+    while (cap < n || cap * sizeof(T) < block_pool::min_bytes) cap <<= 1;
+    return cap;
+  }
+
+  // capacity of a freshly created block: room to grow to 2 * block_size
+  size_t NewCapacity() const { return RoundUp(block_size * 2); }
+
+  typedef double_list<Block, typename std::allocator_traits<Alloc>::template rebind_alloc<Block>> block_list;
+  typedef typename block_list::iterator block_iterator;
+
+  /**
+   * Block directory: one contiguous slot per block, in chain order.
+   * first - origin is the global index of the block's first element,
+   * so a push_front only has to touch slot 0 and origin (the unsigned
+   * wrap-around cancels out). There is spare room on both sides of
+   * [dir_begin, dir_end) so that new end blocks are amortized O(1).
+   *
+   * A middle insert / erase moves the first of every later block by one.
+   * That update is lazy: the slots from lazy_from on still owe
+   * lazy_delta (First() adds it), and Shift() only settles the slots
+   * between the old and the new boundary, so a run of edits in one block
+   * or in neighbouring blocks costs O(1) each instead of O(blocks).
+   */
+  struct Entry {
+    size_t first;
+    block_iterator node;
+  };
+
+  block_pool buffers;  // declared before blocks: blocks hand their buffers back on destruction
+  block_list blocks;
+  size_t total_size = 0;
+  size_t block_size = kInitialBlockSize;
+
+  Entry *dir = nullptr;
+  size_t dir_cap = 0;
+  size_t dir_begin = 0;
+  size_t dir_end = 0;
+  size_t origin = 0;
+  size_t head_base = 0;  // blocks dropped from the front minus blocks added there, see iterator::key
+  size_t lazy_from = 0;   // slot from which on lazy_delta is still to be added
+  size_t lazy_delta = 0;  // unsigned, so a net erase wraps around like origin
+  static const size_t kIdle = static_cast<size_t>(-1);
+  size_t sweep = kIdle;  // relative index of the next block Balance() has to fix
+  /**
+   * With a tree index (kTree) the directory stays unallocated; tree holds
+   * every block's count instead, except that the head block's is off by
+   * head_lag (a push_front / pop_front only moves head_lag) and the tail
+   * block's is not kept up to date at all. origin still counts pushes and
+   * pops at the front, for cursors.
+   */
+  typedef block_tree<block_iterator, typename std::allocator_traits<Alloc>::template rebind_alloc<block_iterator>>
+      block_index;
+  block_index tree;
+  size_t head_lag = 0;  // tree count of the head block minus its real count
+  mutable size_t generation = 0;  // bumped by every change, so that cursors know to re-locate
+  size_t deferred = 0;  // cursor edits since the last Balance()
+  bool cow = false;  // copies share block buffers until written
+  size_t dir_allocations = 0;  // counters for memory_stats()
+  size_t rebalances = 0;
+  size_t resizes = 0;
+#if SJTU_DEQUE_PROFILE
+  mutable deque_profile profile_;
+  mutable size_t walked_ = 0;  // directory entries the last FindBlock / Shift visited
+#endif
+
+  size_t BlockCount() const { return kTree ? tree.size() : dir_end - dir_begin; }
+  Entry &Slot(size_t bi) const { return dir[dir_begin + bi]; }
+  size_t First(size_t s) const { return dir[s].first + (s >= lazy_from ? lazy_delta : 0); }
+  void SetFirst(size_t s, size_t first) { dir[s].first = first - (s >= lazy_from ? lazy_delta : 0); }
+  size_t Start(size_t bi) const {
+    if (kTree) return bi == 0 ? 0 : tree.prefix(bi) - head_lag;
+    return First(dir_begin + bi) - origin;
+  }
+  block_iterator NodeAt(size_t bi) const { return kTree ? tree.at(bi) : Slot(bi).node; }
+
+  // add d to the start of every block after the bi-th one; only the slots the lazy boundary crosses are written
+  void Shift(size_t bi, size_t d) {
+    if (kTree) {
+      if (bi + 1 < tree.size()) tree.add(bi, d);  // the tail's count is not kept
+#if SJTU_DEQUE_PROFILE
+      walked_ = tree.depth();
+#endif
+      return;
+    }
+    size_t from = dir_begin + bi + 1, walked = 0;
+    if (lazy_delta == 0) lazy_from = from;
+    for (; lazy_from < from; ++lazy_from, ++walked) dir[lazy_from].first += lazy_delta;
+    for (; lazy_from > from; ++walked) dir[--lazy_from].first -= lazy_delta;
+    lazy_delta += d;
+#if SJTU_DEQUE_PROFILE
+    walked_ = walked;
+#else
+    (void)walked;
+#endif
+  }
+
+  // rebuild the directory from the block chain, recentering it
+  void Reindex() {
+    SJTU_DEQUE_TIME(reindex);
+    if (kTree) {
+      tree.build(blocks.begin(), blocks.end());
+      head_lag = 0;
+      return;
+    }
+    size_t n = blocks.size();
+    if (dir_cap < 2 * n + 8) {
+      delete[] dir;
+      dir_cap = 4 * n + 16;
+      dir = new Entry[dir_cap];
+      ++dir_allocations;
+    }
+    dir_begin = dir_end = (dir_cap - n) / 2;
+    lazy_from = dir_begin;
+    lazy_delta = 0;
+    size_t first = origin;  // origin is kept, so that cursor indices stay valid
+    for (auto it = blocks.begin(); it != blocks.end(); ++it) {
+      dir[dir_end].first = first;
+      dir[dir_end].node = it;
+      ++dir_end;
+      first += it->count;
+    }
+  }
+
+  // relative index of the block holding the pos-th element (pos < total_size), from the flat directory
+  size_t FindBlock(size_t pos) const {
+    size_t lo = dir_begin, hi = dir_end, probes = 0;
+    while (hi - lo > 1) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (First(mid) - origin <= pos) lo = mid;
+      else hi = mid;
+      ++probes;
+    }
+#if SJTU_DEQUE_PROFILE
+    walked_ = probes;
+#else
+    (void)probes;
+#endif
+    return lo - dir_begin;
+  }
+
+  // block, block index and in-block offset of the pos-th element; pos == total_size gives end()
+  block_iterator Locate(size_t pos, size_t &bi, size_t &offset) const {
+    if (pos == total_size) {
+      bi = BlockCount() - 1;
+      offset = blocks.back().count;
+      return blocks.get_tail();
+    }
+    if (!kTree) {
+      bi = FindBlock(pos);
+      offset = pos - Start(bi);
+      return Slot(bi).node;
+    }
+#if SJTU_DEQUE_PROFILE
+    walked_ = tree.depth();
+#endif
+    if (pos < blocks.front().count) {  // the head block's tree count is off by head_lag
+      bi = 0;
+      offset = pos;
+      return blocks.begin();
+    }
+    size_t before;
+    block_iterator it = tree.find(pos, head_lag, bi, before);
+    offset = pos - before;
+    return it;
+  }
+
+  /**
+   * Keep the tree index in step with a relink (the flat directory is
+   * rebuilt by Reindex() instead): block bi was split in two, blocks bi
+   * and bi + 1 were merged into survivor, or block bi was dropped.
+   */
+  void DirSplit(size_t bi) {
+    if (!kTree) return;
+    block_iterator it = tree.at(bi), next = it;
+    ++next;
+    SetCount(bi, it->count);
+    tree.insert(bi + 1, next, next->count);
+  }
+  void DirMerge(size_t bi, block_iterator survivor) {
+    if (!kTree) return;
+    tree.erase(bi + 1);
+    tree.reset(bi, survivor, survivor->count);
+    if (bi == 0) head_lag = 0;
+  }
+  void DirErase(size_t bi) {
+    if (!kTree) return;
+    tree.erase(bi);
+    if (bi == 0) head_lag = 0;
+  }
+  void SetCount(size_t bi, size_t count) {
+    tree.set(bi, count);
+    if (bi == 0) head_lag = 0;
+  }
+
+  /**
+   * Enter the last (DirAppend) or first (DirPrepend) added blocks of the
+   * chain in the directory, as emplace_back / emplace_front do for one;
+   * Reindex() only when the flat directory has no room left at that end.
+   * DirPrepend expects origin to be moved back over the new elements.
+   */
+  void DirAppend(size_t added) {
+    if (added == 0) return;
+    block_iterator it = blocks.get_tail();
+    for (size_t k = 1; k < added; ++k) --it;
+    if (kTree) {
+      size_t n = tree.size();
+      if (n) SetCount(n - 1, NodeAt(n - 1)->count);  // no longer the tail
+      for (; it != blocks.end(); ++it) tree.insert(tree.size(), it, it->count);
+    } else if (dir_cap - dir_end < added || BlockCount() == 0) {
+      Reindex();
+    } else {
+      for (; it != blocks.end(); ++it, ++dir_end) {
+        SetFirst(dir_end, First(dir_end - 1) + dir[dir_end - 1].node->count);
+        dir[dir_end].node = it;
+      }
+    }
+  }
+  void DirPrepend(size_t added, size_t elements) {
+    if (added == 0) return;
+    block_iterator it = blocks.begin();
+    if (kTree) {
+      if (tree.size()) SetCount(0, NodeAt(0)->count);
+      for (size_t k = 0; k < added; ++k, ++it) tree.insert(k, it, it->count);
+    } else if (dir_begin < added || BlockCount() == 0) {
+      Reindex();
+    } else {
+      size_t first = First(dir_begin) - elements;
+      dir_begin -= added;
+      for (size_t s = dir_begin; s < dir_begin + added; ++s, ++it) {
+        SetFirst(s, first);
+        dir[s].node = it;
+        first += it->count;
+      }
+    }
+  }
+
+  // remove the first (DropFront) or last (DropBack) n elements of that end's block, n <= its count
+  void DropFront(size_t n) {
+    Block &head = blocks.front();
+    total_size -= n;
+    origin += n;
+    if (n == head.count) {
+      blocks.delete_head();
+      ++head_base;
+      if (kTree) DirErase(0);
+      else ++dir_begin;
+      if (sweep != kIdle && sweep > 0) --sweep;
+      return;
+    }
+    if (Block::raw) {  // only head and count change, so a shared buffer needs no own()
+      head.head = (head.head + n) & head.mask();
+      head.count -= n;
+    } else {
+      head.erase(0, n);
+    }
+    if (kTree) head_lag += n;
+    else dir[dir_begin].first += n;
+  }
+  void DropBack(size_t n) {
+    Block &tail = blocks.back();
+    total_size -= n;
+    if (n == tail.count) {
+      blocks.delete_tail();
+      if (kTree) DirErase(tree.size() - 1);
+      else --dir_end;
+      return;
+    }
+    if (Block::raw) tail.count -= n;
+    else tail.erase(tail.count - n, n);
+  }
+
+  /**
+   * Called after every modification. A block size change only restarts
+   * the sweep; each call then fixes at most Policy::fixes_per_op blocks,
+   * so no single operation pays for the whole chain. Returns whether it
+   * relinked the chain, i.e. whether iterators and block indices moved.
+   */
+  bool Balance() {
+    if (blocks.empty()) return false;
+
+    size_t new_block_size = Policy::block_size(total_size, block_size);
+    if (new_block_size != block_size) {
+      block_size = new_block_size;
+      sweep = 0;
+      ++resizes;
+    }
+    if (sweep >= BlockCount()) {
+      sweep = kIdle;
+      return false;
+    }
+    SJTU_DEQUE_TIME(balance);
+
+    bool relinked = false;
+    size_t budget = Policy::fixes_per_op;
+    auto it = NodeAt(sweep);
+    while (budget-- && it != blocks.end()) {
+      if (it->count > block_size * 2) {
+        Split(it);
+        DirSplit(sweep);
+        relinked = true;
+      }
+      else if ((it->count) * 2 < block_size) {
+        size_t before = blocks.size();
+        it = Merge(it);  // the survivor takes over index sweep
+        if (blocks.size() != before) {
+          DirMerge(sweep, it);
+          relinked = true;
+          continue;  // it may still be small enough to take the next block too
+        }
+      }
+      ++it;
+      ++sweep;
+    }
+    if (it == blocks.end()) sweep = kIdle;
+    if (relinked && !kTree) Reindex();
+    return relinked;
+  }
+
+  /**
+   * Merge and Split only relink the chain; callers Reindex() afterwards,
+   * or update a tree index through DirMerge / DirSplit.
+   * Merge drains the smaller of it and its successor into the larger one,
+   * so it costs min(count) moves, and returns the block that survives.
+   */
+  block_iterator Merge(block_iterator it) {
+    auto next = it;
+    ++next;
+    if (next == blocks.end()) return it;
+    Block &current_block = *it;
+    Block &next_block = *next;
+
+    size_t merged = current_block.count + next_block.count;
+    if (merged > block_size) return it;
+    SJTU_DEQUE_TIME(merge);
+    ++rebalances;
+    if (current_block.count >= next_block.count) {
+      current_block.reserve(RoundUp(merged));
+      next_block.move_back_to(current_block, next_block.count);
+      blocks.erase(next);
+      return it;
+    }
+    next_block.reserve(RoundUp(merged));
+    current_block.move_front_to(next_block, current_block.count);
+    blocks.erase(it);
+    return next;
+  }
+
+  void Split(block_iterator it) {
+    if (it->count <= block_size) return;
+    SJTU_DEQUE_TIME(split);
+    ++rebalances;
+
+    auto next = it;
+    ++next;
+    size_t moved = it->count - it->count / 2;
+    size_t capacity = NewCapacity();
+    if (capacity <= moved) capacity = RoundUp(moved + 1);  // a block left over from a larger block_size; emplace may add one
+    auto new_it = blocks.emplace(next, &buffers, capacity);
+
+    // Move the second half of the items to the new block
+    it->move_back_to(*new_it, moved);
+  }
+
+public:
+  class const_iterator;
+  class iterator {
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T *pointer;
+    typedef T &reference;
+    typedef T *segment_pointer;  // marks a segmented iterator, see deque_algorithm.hpp
+
+    size_t offset;
+    size_t key;  // block index plus outer->head_base, so that end operations leave it valid
+    block_iterator block_it;
+    deque *outer;
+    T *cur = nullptr;      // the element at offset, null at end(); ++ only has to bump it
+    T *seg_end = nullptr;  // end of the contiguous run of the block that cur is in
+
+    iterator() : offset(0), key(0), block_it(), outer(nullptr) {}
+
+    iterator(const iterator& other)
+      : offset(other.offset), key(other.key), block_it(other.block_it), outer(other.outer),
+        cur(other.cur), seg_end(other.seg_end) {}
+
+    iterator(size_t off, size_t b, block_iterator b_it, deque *out):
+      offset(off), key(b + out->head_base), block_it(b_it), outer(out){ Sync(); }
+
+    // index of the block in the directory, as of now
+    size_t Bi() const { return key - outer->head_base; }
+
+    // recompute cur and seg_end from block_it and offset
+    void Sync() {
+      if (block_it == nullptr || offset >= block_it->count) {
+        cur = seg_end = nullptr;
+        return;
+      }
+      Block &block = *block_it;
+      if (block.refs) block.own();  // writes through cur must not reach a shared buffer
+      size_t phys = (block.head + offset) & block.mask();
+      size_t run = phys + (block.count - offset);
+      cur = block.data + phys;
+      seg_end = block.data + (run < block.width() ? run : block.width());
+    }
+
+    // ++ ran off the run: wrap around inside the block or move to the next one
+    void Advance() {
+      if (offset == block_it->count && block_it != outer->blocks.get_tail()) {
+        ++block_it;
+        ++key;
+        offset = 0;
+      }
+      Sync();
+    }
+
+    iterator& operator=(const iterator& other) {
+      if (this != &other) {
+        offset = other.offset;
+        key = other.key;
+        block_it = other.block_it;
+        outer = other.outer;
+        cur = other.cur;
+        seg_end = other.seg_end;
+      }
+      return *this;
+    }
+
+    // global index, taken from the directory
+    size_t index() const {
+      return block_it == nullptr ? 0 : outer->Start(Bi()) + offset;
+    }
+
+    /**
+     * return a new iterator which points to the n-next element.
+     * if there are not enough elements, the behaviour is undefined.
+     * same for operator-.
+     */
+    iterator operator+(difference_type n) const {
+      if(n<0) return *this - (-n);
+
+      iterator temp = *this;
+      if (n == 0) return temp;
+      if(temp.block_it == nullptr) throw std::out_of_range("");
+
+      if (temp.offset + n < temp.block_it->count) {
+        temp.offset += n;
+        temp.Sync();
+        return temp;
+      }
+      size_t target = index() + n;
+      if (target > outer->total_size) throw std::out_of_range("");
+      return outer->IteratorAt(target);
+    }
+    // additional iterator operations
+
+    iterator operator-(difference_type n) const {
+      if(n<0) return *this + (-n);
+
+      iterator temp = *this;
+      if (n == 0) return temp;
+      if(temp.block_it == nullptr) throw std::out_of_range("");
+
+      if (static_cast<size_t>(n) <= temp.offset) {
+        temp.offset -= n;
+        temp.Sync();
+        return temp;
+      }
+      size_t current = index();
+      if (static_cast<size_t>(n) > current) throw std::out_of_range("");
+      return outer->IteratorAt(current - n);
+    }
+
+    /**
+     * return the distance between two iterators.
+     * if they point to different vectors, throw
+     * invaild_iterator.
+     */
+    difference_type operator-(const iterator& rhs) const {
+      if (outer != rhs.outer || outer == nullptr)
+        throw std::out_of_range("");
+
+      return static_cast<difference_type>(index()) - static_cast<difference_type>(rhs.index());
+    }
+
+    iterator &operator+=(difference_type n) {
+      *this = *this + n;
+      return *this;
+    }
+
+    iterator &operator-=(difference_type n) {
       *this = *this - n;
       return *this;
     }
 
+    friend iterator operator+(difference_type n, const iterator &it) { return it + n; }
+
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    // ordering by global index; both iterators must belong to the same deque
+    bool operator<(const iterator &rhs) const { return index() < rhs.index(); }
+    bool operator>(const iterator &rhs) const { return rhs < *this; }
+    bool operator<=(const iterator &rhs) const { return !(rhs < *this); }
+    bool operator>=(const iterator &rhs) const { return !(*this < rhs); }
+
     /**
      * iter++
      */
     iterator operator++(int) {
       iterator old = *this;
-      if(block_it==outer->blocks.end()) throw std::out_of_range("");
-      if(block_it == outer->blocks.get_tail() && item_it == block_it->items.end())
-        throw std::out_of_range("");
-      if(item_it == block_it->items.end())
-        throw std::out_of_range("");
-      ++item_it;
-      if(item_it == block_it->items.end() && block_it != outer->blocks.get_tail()){
-        ++block_it;
-        item_it = block_it->items.begin();
-      }        
+      ++*this;
       return old;
     }
     /**
      * ++iter
      */
     iterator &operator++() {
-      if(block_it==outer->blocks.end()) throw std::out_of_range("");
-      if(block_it == outer->blocks.get_tail() && item_it == block_it->items.end())
-        throw std::out_of_range("");
-      if(item_it == block_it->items.end())
-        throw std::out_of_range("");
-      ++item_it;
-      if(item_it == block_it->items.end() && block_it != outer->blocks.get_tail()){
-        ++block_it;
-        item_it = block_it->items.begin();
-      } 
+#if SJTU_DEQUE_CHECKED
+      if (cur == nullptr) throw std::out_of_range("");
+#endif
+      ++offset;
+      if (++cur == seg_end) Advance();
       return *this;
     }
     iterator operator--(int) {
       iterator old = *this;
-      if(*this == outer->end()) {
-        block_it = outer->blocks.get_tail();
-        item_it = block_it->items.get_tail();
-        return old;
-      }
-
-      if(block_it==outer->blocks.begin() && item_it==block_it->items.begin())
-        throw std::out_of_range("");
-
-      if(item_it == block_it->items.end())
-        throw std::out_of_range("");
-            
-      if(item_it == block_it->items.begin()) {
-        --block_it;
-        item_it = block_it->items.get_tail();
-      }
-      else --item_it;
-
+      --*this;
       return old;
     }
     iterator &operator--() {
-      if(*this == outer->end()) {
-        block_it = outer->blocks.get_tail();
-        item_it = block_it->items.get_tail();
-        return *this;
-      }     
-
-      if(block_it==outer->blocks.begin() && item_it==block_it->items.begin())
-        throw std::out_of_range("");
-
-      if(item_it == block_it->items.end())
-        throw std::out_of_range("");
-            
-      if(item_it == block_it->items.begin()) {
+#if SJTU_DEQUE_CHECKED
+      if (block_it == nullptr || (offset == 0 && Bi() == 0)) throw std::out_of_range("");
+#endif
+      if(offset == 0) {
         --block_it;
-        item_it = block_it->items.get_tail();
+        --key;
+        offset = block_it->count;
       }
-      else --item_it;
+      --offset;
+      Sync();
 
       return *this;
     }
 
     // *it
-    T &operator*() const {return *item_it;}
+    T &operator*() const {
+#if SJTU_DEQUE_CHECKED
+      if (cur == nullptr) throw std::out_of_range("");
+#endif
+      return *cur;
+    }
     // it->field
-    T *operator->() const noexcept {return &(*item_it);}
+    T *operator->() const noexcept {return cur;}
 
     /**
      * check whether two iterators are the same (pointing to the same
      * memory).
      */
     bool operator==(const iterator &rhs) const {
-      return block_it == rhs.block_it && item_it == rhs.item_it;
+      return block_it == rhs.block_it && offset == rhs.offset;
     }
     bool operator==(const const_iterator &rhs) const {
-      return block_it == rhs.block_it && item_it == rhs.item_it;
+      return block_it == rhs.block_it && offset == rhs.offset;
     }
     bool operator!=(const iterator &rhs) const {
-      return block_it != rhs.block_it || item_it !=rhs.item_it;
+      return block_it != rhs.block_it || offset != rhs.offset;
     }
     bool operator!=(const const_iterator &rhs) const {
-      return block_it != rhs.block_it || item_it !=rhs.item_it;
+      return block_it != rhs.block_it || offset != rhs.offset;
     }
   };
 
   class const_iterator {
   public:
-    typename double_list<T>::iterator item_it;
-    typename double_list<Block>::iterator block_it;
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const T *pointer;
+    typedef const T &reference;
+    typedef const T *segment_pointer;
+
+    size_t offset;
+    size_t key;  // as in iterator
+    block_iterator block_it;
     const deque *outer;
+    T *cur = nullptr;      // the element at offset, null at end(); ++ only has to bump it
+    T *seg_end = nullptr;  // end of the contiguous run of the block that cur is in
 
-    const_iterator() : item_it(), block_it(), outer(nullptr) {}
+    const_iterator() : offset(0), key(0), block_it(), outer(nullptr) {}
 
     const_iterator(const iterator &it):
-      item_it(it.item_it), block_it(it.block_it), outer(it.outer) {}
-    const_iterator(const const_iterator& other) 
-      : item_it(other.item_it), block_it(other.block_it), outer(other.outer) {}
+      offset(it.offset), key(it.key), block_it(it.block_it), outer(it.outer),
+      cur(it.cur), seg_end(it.seg_end) {}
+    const_iterator(const const_iterator& other)
+      : offset(other.offset), key(other.key), block_it(other.block_it), outer(other.outer),
+        cur(other.cur), seg_end(other.seg_end) {}
+
+    const_iterator(size_t off, size_t b, block_iterator b_it, const deque *out):
+      offset(off), key(b + out->head_base), block_it(b_it), outer(out){ Sync(); }
+
+    size_t Bi() const { return key - outer->head_base; }
+
+    // recompute cur and seg_end from block_it and offset
+    void Sync() {
+      if (block_it == nullptr || offset >= block_it->count) {
+        cur = seg_end = nullptr;
+        return;
+      }
+      const Block &block = *block_it;
+      size_t phys = (block.head + offset) & block.mask();
+      size_t run = phys + (block.count - offset);
+      cur = block.data + phys;
+      seg_end = block.data + (run < block.width() ? run : block.width());
+    }
 
-    const_iterator(typename double_list<T>::iterator i_it, typename double_list<Block>::iterator b_it, const deque *out):
-      item_it(i_it), block_it(b_it), outer(out){}
+    // ++ ran off the run: wrap around inside the block or move to the next one
+    void Advance() {
+      if (offset == block_it->count && block_it != outer->blocks.get_tail()) {
+        ++block_it;
+        ++key;
+        offset = 0;
+      }
+      Sync();
+    }
 
     const_iterator& operator=(const const_iterator& other) {
       if (this != &other) {
-        item_it = other.item_it;
+        offset = other.offset;
+        key = other.key;
         block_it = other.block_it;
         outer = other.outer;
+        cur = other.cur;
+        seg_end = other.seg_end;
       }
       return *this;
     }
 
-    const_iterator operator+(const int &n) const {
+    size_t index() const {
+      return block_it == nullptr ? 0 : outer->Start(Bi()) + offset;
+    }
+
+    const_iterator operator+(difference_type n) const {
       if(n<0) return *this - (-n);
 
-      const_iterator temp = *this;
-      if (n == 0) return temp;
-      if(temp.block_it == nullptr) throw std::out_of_range("");
+      const_iterator temp = *this;
+      if (n == 0) return temp;
+      if(temp.block_it == nullptr) throw std::out_of_range("");
+
+      if (temp.offset + n < temp.block_it->count) {
+        temp.offset += n;
+        temp.Sync();
+        return temp;
+      }
+      size_t target = index() + n;
+      if (target > outer->total_size) throw std::out_of_range("");
+      return outer->ConstIteratorAt(target);
+    }
+    // additional iterator operations
+
+    const_iterator operator-(difference_type n) const {
+      if(n<0) return *this + (-n);
+
+      const_iterator temp = *this;
+      if (n == 0) return temp;
+      if(temp.block_it == nullptr) throw std::out_of_range("");
+
+      if (static_cast<size_t>(n) <= temp.offset) {
+        temp.offset -= n;
+        temp.Sync();
+        return temp;
+      }
+      size_t current = index();
+      if (static_cast<size_t>(n) > current) throw std::out_of_range("");
+      return outer->ConstIteratorAt(current - n);
+    }
+
+    difference_type operator-(const const_iterator& rhs) const {
+      if (outer != rhs.outer || outer == nullptr)
+        throw std::out_of_range("");
+
+      return static_cast<difference_type>(index()) - static_cast<difference_type>(rhs.index());
+    }
+
+    const_iterator &operator+=(difference_type n) {
+      *this = *this + n;
+      return *this;
+    }
+
+    const_iterator &operator-=(difference_type n) {
+      *this = *this - n;
+      return *this;
+    }
+
+    friend const_iterator operator+(difference_type n, const const_iterator &it) { return it + n; }
+
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    // ordering by global index; both iterators must belong to the same deque
+    bool operator<(const const_iterator &rhs) const { return index() < rhs.index(); }
+    bool operator>(const const_iterator &rhs) const { return rhs < *this; }
+    bool operator<=(const const_iterator &rhs) const { return !(rhs < *this); }
+    bool operator>=(const const_iterator &rhs) const { return !(*this < rhs); }
+
+    /**
+     * iter++
+     */
+    const_iterator operator++(int) {
+      const_iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    const_iterator &operator++() {
+#if SJTU_DEQUE_CHECKED
+      if (cur == nullptr) throw std::out_of_range("");
+#endif
+      ++offset;
+      if (++cur == seg_end) Advance();
+      return *this;
+    }
+    const_iterator operator--(int) {
+      const_iterator old = *this;
+      --*this;
+      return old;
+    }
+    const_iterator &operator--() {
+#if SJTU_DEQUE_CHECKED
+      if (block_it == nullptr || (offset == 0 && Bi() == 0)) throw std::out_of_range("");
+#endif
+      if(offset == 0) {
+        --block_it;
+        --key;
+        offset = block_it->count;
+      }
+      --offset;
+      Sync();
+
+      return *this;
+    }
+
+    // *it
+    const T &operator*() const {
+#if SJTU_DEQUE_CHECKED
+      if (cur == nullptr) throw std::out_of_range("");
+#endif
+      return *cur;
+    }
+    // it->field
+    const T *operator->() const noexcept {return cur;}
+
+    /**
+     * check whether two iterators are the same (pointing to the same
+     * memory).
+     */
+    const bool operator==(const iterator &rhs) const {
+      return block_it == rhs.block_it && offset == rhs.offset;
+    }
+    const bool operator==(const const_iterator &rhs) const {
+      return block_it == rhs.block_it && offset == rhs.offset;
+    }
+    const bool operator!=(const iterator &rhs) const {
+      return block_it != rhs.block_it || offset != rhs.offset;
+    }
+    const bool operator!=(const const_iterator &rhs) const {
+      return block_it != rhs.block_it || offset != rhs.offset;
+    }
+  };
+
+  /**
+   * A position for streaming edits. A cursor names an index counted like
+   * the directory (relative to origin), so push_front / pop_front leave it
+   * on the same element and push_back never moves it; splits and merges
+   * do not change indices either. It caches the iterator for that index.
+   *
+   * Edits through the cursor keep the cache up to date and skip
+   * Balance(), which runs once every block_size of them instead, so a
+   * run of edits around one place costs the in-block move and nothing
+   * else. After any other change to the deque (another cursor's edits
+   * included) the next use re-locates the cursor by its index, in
+   * O(log blocks), clamped to [0, size()]. A cursor may sit at end().
+   * It must not outlive its deque.
+   */
+  class cursor {
+  public:
+    cursor() : outer(nullptr), key(0), seen(0) {}
+
+    size_t index() const {
+      std::ptrdiff_t at = static_cast<std::ptrdiff_t>(key - outer->origin);
+      if (at < 0) return 0;
+      return static_cast<size_t>(at) > outer->total_size ? outer->total_size : at;
+    }
+    bool at_end() const { return index() == outer->total_size; }
+
+    // the element under the cursor; throws at end()
+    T &operator*() {
+      Refresh();
+      if (it.cur == nullptr) throw std::out_of_range("");
+      return *it.cur;
+    }
+    T *operator->() { return &**this; }
+
+    iterator position() {
+      Refresh();
+      return it;
+    }
+
+    void move_to(size_t pos) {
+      if (pos > outer->total_size) throw std::out_of_range("");
+      key = pos + outer->origin;
+      seen = outer->generation - 1;
+    }
+
+    // step k elements (either way); O(1) inside the current block
+    void move_by(std::ptrdiff_t k) {
+      Refresh();
+      size_t at = index();
+      if (k < 0 ? static_cast<size_t>(-k) > at : static_cast<size_t>(k) > outer->total_size - at)
+        throw std::out_of_range("");
+      key += k;
+      if (it.block_it != nullptr && (k < 0 ? static_cast<size_t>(-k) <= it.offset
+                                           : it.offset + k < it.block_it->count)) {
+        it.offset += k;
+        it.Sync();
+        return;
+      }
+      seen = outer->generation - 1;
+    }
+
+    // construct an element in front of the cursor, which stays on its element
+    template <class... Args>
+    void emplace_before(Args &&...args) {
+      Refresh();
+      ++outer->generation;
+      if (outer->blocks.empty()) {
+        outer->emplace_back(std::forward<Args>(args)...);
+        ++key;
+        seen = outer->generation - 1;
+        return;
+      }
+      outer->EmplaceAt(it, std::forward<Args>(args)...);
+      ++key;
+      ++it;  // back on the element the cursor was on
+      Edited();
+    }
+    void insert_before(const T &value) { emplace_before(value); }
+    void insert_before(T &&value) { emplace_before(std::move(value)); }
+
+    // remove the element under the cursor, which moves on to the next one; throws at end()
+    void erase_at() {
+      Refresh();
+      if (it.cur == nullptr) throw std::out_of_range("");
+      ++outer->generation;
+      outer->EraseAt(it);
+      Edited();
+    }
+
+  private:
+    friend class deque;
+    deque *outer;
+    size_t key;  // index + origin at the time of the last edit
+    size_t seen;  // outer->generation the cached iterator belongs to
+    iterator it;
+
+    cursor(deque *d, size_t pos) : outer(d), key(pos + d->origin), seen(d->generation), it(d->IteratorAt(pos)) {}
+
+    void Refresh() {
+      if (seen == outer->generation) return;
+      size_t pos = index();
+      key = pos + outer->origin;
+      it = outer->IteratorAt(pos);
+      seen = outer->generation;
+    }
+
+    // after an edit of this cursor: rebalance now and then, keep the cache unless that relinked the chain
+    void Edited() {
+      seen = outer->generation;
+      if (++outer->deferred < outer->block_size) return;
+      outer->deferred = 0;
+      if (outer->Balance()) seen = outer->generation - 1;
+    }
+  };
+
+  // a cursor at index pos (pos == size() gives one at end())
+  cursor cursor_at(size_t pos) {
+    if (pos > total_size) throw std::out_of_range("");
+    return cursor(this, pos);
+  }
+
+private:
+  /**
+   * clone other's blocks in one pass, each into a buffer of the same
+   * capacity from this deque's own pool; in copy-on-write mode the
+   * buffers are shared instead. Only called on an empty deque.
+   */
+  void CopyFrom(const deque &other) {
+    if (other.cow) ++other.generation;  // its blocks become shared: cursors have to unshare them again
+    for (auto it = other.blocks.begin(); it != other.blocks.end(); ++it) {
+      const Block &block = *it;
+      if (other.cow) blocks.emplace_tail(block, &buffers, typename Block::share_tag());
+      else blocks.emplace_tail(block, &buffers);
+    }
+    total_size = other.total_size;
+    block_size = other.block_size;
+    sweep = other.sweep;
+    cow = other.cow;
+    Reindex();
+  }
+
+  // point every block at this deque's pool after the chain changed hands
+  void AdoptBlocks() {
+    for (auto it = blocks.begin(); it != blocks.end(); ++it) it->pool = &buffers;
+  }
+
+  // sources for FillBefore: fill() constructs up to room elements at a block's back
+  template <class InputIt>
+  struct RangeSource {
+    InputIt first, last;
+    bool done() const { return first == last; }
+    void fill(Block &block, size_t room) {
+      for (; room && first != last; --room, ++first) block.emplace_back(*first);
+    }
+  };
+  struct CopySource {
+    const T &value;
+    size_t n;
+    bool done() const { return n == 0; }
+    void fill(Block &block, size_t room) {
+      for (; room && n; --room, --n) block.emplace_back(value);
+    }
+  };
+
+  // whether a batch can memcpy through It: trivially copyable elements behind a plain pointer
+  template <class It>
+  using RawPointer = std::integral_constant<bool, Block::raw &&
+      (std::is_same<It, T *>::value || std::is_same<It, const T *>::value)>;
+
+  // source for FillBefore: the n elements from first on, appended by memcpy where RawPointer allows
+  template <class InputIt>
+  struct CountedSource {
+    InputIt first;
+    size_t n;
+    bool done() const { return n == 0; }
+    void fill(Block &block, size_t room) { fill(block, room < n ? room : n, RawPointer<InputIt>()); }
+    void fill(Block &block, size_t k, std::true_type) {
+      if (block.refs) block.own();
+      block.append_raw(first, k);
+      first += k;
+      n -= k;
+    }
+    void fill(Block &block, size_t k, std::false_type) {
+      for (; k; --k, --n, ++first) block.emplace_back(*first);
+    }
+  };
+
+  // construct the n elements from first on in front of block's first one, in order
+  template <class InputIt>
+  static void PrependTo(Block &block, InputIt first, size_t n, std::true_type) {
+    if (block.refs) block.own();
+    block.prepend_raw(first, n);
+  }
+  template <class InputIt>
+  static void PrependTo(Block &block, InputIt first, size_t n, std::false_type) {
+    if (block.refs) block.own();
+    size_t start = block.head - n, k = 0;
+    try {
+      for (; k < n; ++k, ++first) new (block.slot(start + k)) T(*first);
+    } catch (...) {
+      while (k) block.slot(start + --k)->~T();
+      throw;
+    }
+    block.head = start & block.mask();
+    block.count += n;
+  }
+
+  /**
+   * write block's elements [from, from + n) to out: memcpy for RawPointer,
+   * else moved out one by one. done is advanced per element written, so
+   * that a caller can still remove them when a write throws.
+   */
+  template <class OutputIt>
+  static OutputIt TakeFrom(Block &block, size_t from, size_t n, OutputIt out, size_t &done, std::true_type) {
+    const Block &source = block;  // a read must not unshare the block
+    for (size_t k = 0; k < n;) {
+      size_t len = source.run(from + k, n - k);
+      std::memcpy(static_cast<void *>(out), source.slot(source.head + from + k), len * sizeof(T));
+      out += len;
+      k += len;
+    }
+    done += n;
+    return out;
+  }
+  template <class OutputIt>
+  static OutputIt TakeFrom(Block &block, size_t from, size_t n, OutputIt out, size_t &done, std::false_type) {
+    for (size_t i = from; i < from + n; ++i, ++out, ++done) *out = std::move(block[i]);
+    return out;
+  }
+
+  template <class Writer>
+  void SerializeElements(Writer &write, const deque_wire_header &header, std::true_type) const {
+    std::unique_ptr<deque_span[]> spans(new deque_span[1 + 2 * blocks.size()]);
+    size_t n = 0;
+    spans[n++] = deque_span{&header, sizeof(header)};
+    for (auto it = blocks.begin(); it != blocks.end(); ++it) {
+      const Block &block = *it;
+      size_t first = block.run(0, block.count);
+      spans[n++] = deque_span{block.slot(block.head), first * sizeof(T)};
+      if (first < block.count) spans[n++] = deque_span{block.data, (block.count - first) * sizeof(T)};
+    }
+    write(static_cast<const deque_span *>(spans.get()), n);
+  }
 
-      int remain = n;
-      int block_remaining = std::distance(temp.item_it, temp.block_it->items.end());
-      if(remain<block_remaining) {
-        std::advance(temp.item_it, remain);
-        return temp;
-      }
+  template <class Writer>
+  void SerializeElements(Writer &write, const deque_wire_header &header, std::false_type) const {
+    deque_span span = {&header, sizeof(header)};
+    write(static_cast<const deque_span *>(&span), size_t(1));
+    for (auto it = blocks.begin(); it != blocks.end(); ++it) {
+      const Block &block = *it;  // a read must not unshare the block
+      for (size_t i = 0; i < block.count; ++i) deque_serial<T>::write(block[i], write);
+    }
+  }
 
-      remain -= block_remaining;
-      if(!remain && temp.block_it == outer->blocks.get_tail())
-        return outer->cend();
-      
-      ++temp.block_it;
-      if(temp.block_it == outer->blocks.end()) throw std::out_of_range("");
-      temp.item_it = temp.block_it->items.begin();
-      while (remain > 0) {       
-        if (remain < temp.block_it->items.size())
-          break;
-        else {
-          remain -= temp.block_it->items.size();   
-          if (temp.block_it != outer->blocks.get_tail()) {
-            ++temp.block_it;
-            temp.item_it = temp.block_it->items.begin();
-          }
-          else {
-            if(remain)
-              throw std::out_of_range("");
-            else temp.item_it = temp.block_it->items.end();
-          }
-        }
+  // source for FillBefore: n elements from a serialized deque, raw bytes read straight into the ring
+  template <class Reader, bool Raw>
+  struct ReadSource {
+    Reader &read;
+    size_t n;
+    bool done() const { return n == 0; }
+    void fill(Block &block, size_t room) { fill(block, room, std::integral_constant<bool, Raw>()); }
+    void fill(Block &block, size_t room, std::true_type) {
+      while (room && n) {
+        size_t len = block.run(block.count, room < n ? room : n);
+        read(static_cast<void *>(block.slot(block.head + block.count)), len * sizeof(T));
+        block.count += len;
+        room -= len;
+        n -= len;
       }
-
-      std::advance(temp.item_it, remain);
-      return temp;
     }
-    // additional iterator operations
+    void fill(Block &block, size_t room, std::false_type) {
+      for (; room && n; --room, --n) block.emplace_back(deque_serial<T>::read(read));
+    }
+  };
 
-    const_iterator operator-(const int &n) const {
-      if(n<0) return *this + (-n);
+  // element count of a range, when it can be known without consuming it
+  template <class It>
+  static size_t Distance(It first, It last, std::forward_iterator_tag) {
+    return std::distance(first, last);
+  }
+  template <class It>
+  static size_t Distance(It, It, std::input_iterator_tag) { return 0; }
 
-      const_iterator temp = *this; 
-      if (n == 0) return temp;
+  // adopt the block size for n more elements before building blocks at it
+  void Anticipate(size_t n) {
+    size_t new_block_size = Policy::block_size(total_size + n, block_size);
+    if (new_block_size != block_size) {
+      block_size = new_block_size;
+      sweep = 0;
+      ++resizes;
+    }
+  }
 
-      int remain = n;
-      if(temp == outer->cend()) {
-        temp.block_it = outer->blocks.get_tail();
-        temp.item_it = temp.block_it->items.get_tail();
-        --remain;
-      }
+  // the block in front of at, or blocks.end() when at is the first one
+  block_iterator Before(block_iterator at) const {
+    if (at == blocks.end()) return blocks.get_tail();
+    if (at == blocks.begin()) return blocks.end();
+    return --at;
+  }
 
-      int block_remaining = std::distance(temp.block_it->items.begin(),temp.item_it);
-      if(remain<=block_remaining){
-        while(remain--)
-          --temp.item_it;
-        return temp;
-      }
-      if(temp.block_it==outer->blocks.begin()) throw std::out_of_range("");
-      remain-=block_remaining;
-      --remain;
-      --temp.block_it;
-      temp.item_it = temp.block_it->items.get_tail();
-
-      while (remain > 0) {
-        if(remain<temp.block_it->items.size())
-          break;
-           
-        if(temp.block_it==outer->blocks.begin()) throw std::out_of_range("");
-        remain-=temp.block_it->items.size();
-        --temp.block_it;
-        temp.item_it = temp.block_it->items.get_tail();
-      } 
-
-      while(remain--){
-        --temp.item_it;
-      }
-      return temp;
-    }
-
-    const size_t operator-(const const_iterator& rhs) const {
-      if (block_it==nullptr || rhs.block_it==nullptr)
-        throw std::out_of_range("");      
-
-      size_t distance = 0;
-      auto temp_block_it = rhs.block_it;
-      auto temp_item_it = rhs.item_it;     
-
-      if (block_it == rhs.block_it) {
-        bool f=0;
-        while(temp_item_it!=item_it){
-          if(temp_item_it == temp_block_it->items.end()){
-            f=1;
-            break;
-          }
-          distance++;
-          ++temp_item_it;
-        }
-        if(f) return -std::distance(item_it, rhs.item_it);
-        else return distance;
-      }
+  // split the block at it in front of its offset-th element; returns the block that starts there
+  block_iterator Cut(block_iterator it, size_t offset) {
+    auto next = it;
+    ++next;
+    if (offset == 0) return it;
+    if (offset == it->count) return next;
+    auto rest = blocks.emplace(next, &buffers, it->cap);
+    it->move_back_to(*rest, it->count - offset);
+    return rest;
+  }
 
-      distance += std::distance(temp_item_it, temp_block_it->items.end());
-      ++temp_block_it;
-      
-      bool f=1;
-      while (temp_block_it != block_it) {
-        if(temp_block_it == rhs.outer->blocks.end()){
-          f=0;
-          break;
-        }        
-        distance += temp_block_it->items.size();
-        ++temp_block_it;
-      }
-      if(f) {
-        temp_item_it = temp_block_it->items.begin();       
-        distance += std::distance(temp_item_it, item_it);
-        return distance;
+  /**
+   * insert everything src yields in front of the block at: the block before
+   * at is topped up to block_size, then whole blocks are built in place.
+   * The directory is left stale. If an element constructor throws, what was
+   * built so far stays in the deque and the directory is rebuilt.
+   */
+  template <class Source>
+  void FillBefore(block_iterator at, Source &src) {
+    block_iterator it = Before(at);
+    size_t base = 0;
+    try {
+      if (it != blocks.end()) {
+        size_t limit = block_size < it->cap ? block_size : it->cap;
+        base = it->count;
+        if (base < limit) src.fill(*it, limit - base);
+        total_size += it->count - base;
+        base = it->count;
       }
-
-      distance = 0;
-      temp_block_it = block_it;
-      temp_item_it = item_it;  
-      distance += std::distance(temp_item_it, temp_block_it->items.end());
-      ++temp_block_it;
-      
-      f=1;
-      while (temp_block_it != rhs.block_it) {
-        if(temp_block_it == outer->blocks.end()){
-          f=0;
-          break;
-        }        
-        distance += temp_block_it->items.size();
-        ++temp_block_it;
+      while (!src.done()) {
+        it = blocks.emplace(at, &buffers, NewCapacity());
+        base = 0;
+        src.fill(*it, block_size);
+        total_size += it->count;
+        base = it->count;
       }
-      if(f) {
-        temp_item_it = temp_block_it->items.begin();       
-        distance += std::distance(temp_item_it, rhs.item_it);
-        return -distance;
+    } catch (...) {
+      if (it != blocks.end()) {
+        total_size += it->count - base;
+        if (it->count == 0) blocks.erase(it);
       }
-      else throw std::out_of_range("");
-    }
-
-    const_iterator operator+=(const int &n) {
-      *this = *this + n;
-      return *this;
-    }
-
-    const_iterator operator-=(const int &n) {
-      *this = *this - n;
-      return *this;
+      Reindex();
+      throw;
     }
+  }
 
-    /**
-     * iter++
-     */
-    const_iterator operator++(int) {
-      const_iterator old = *this;
-      if(block_it==outer->blocks.end()) throw std::out_of_range("");
-      if(block_it == outer->blocks.get_tail() && item_it == block_it->items.end())
-        throw std::out_of_range("");
-      if(item_it == block_it->items.end())
-        throw std::out_of_range("");
-      ++item_it;
-      if(item_it == block_it->items.end() && block_it != outer->blocks.get_tail()){
-        ++block_it;
-        item_it = block_it->items.begin();
-      }        
-      return old;
+  template <class Source>
+  iterator InsertFrom(iterator pos, Source &src, size_t hint) {
+    if (pos.outer != this || (pos.block_it == nullptr) != blocks.empty()) {
+      throw std::out_of_range("");
     }
+    size_t dis = pos.index();
+    if (dis > total_size) throw std::out_of_range("");
+    if (src.done()) return pos;
+    ++generation;
 
-    const_iterator &operator++() {
-      if(block_it==outer->blocks.end()) throw std::out_of_range("");
-      if(block_it == outer->blocks.get_tail() && item_it == block_it->items.end())
-        throw std::out_of_range("");
-      if(item_it == block_it->items.end())
-        throw std::out_of_range("");
-      ++item_it;
-      if(item_it == block_it->items.end() && block_it != outer->blocks.get_tail()){
-        ++block_it;
-        item_it = block_it->items.begin();
-      } 
-      return *this;
-    }
-    const_iterator operator--(int) {
-      const_iterator old = *this;
-      if(*this == outer->end()) {
-        block_it = outer->blocks.get_tail();
-        item_it = block_it->items.get_tail();
-        return old;
-      }
+    Anticipate(hint);
+    if (sweep != kIdle && sweep > pos.Bi()) sweep = pos.Bi();
+    block_iterator at = blocks.empty() ? blocks.end() : Cut(pos.block_it, pos.offset);
+    FillBefore(at, src);
 
-      if(block_it==outer->blocks.begin() && item_it==block_it->items.begin())
-        throw std::out_of_range("");
+    block_iterator left = Before(at);  // mend the seam the cut left behind
+    if (at != blocks.end() && left != blocks.end()) Merge(left);
+    Reindex();
+    Balance();
+    return IteratorAt(dis);
+  }
 
-      if(item_it == block_it->items.end())
-        throw std::out_of_range("");
-            
-      if(item_it == block_it->items.begin()) {
-        --block_it;
-        item_it = block_it->items.get_tail();
+  /**
+   * construct an element before pos and leave pos on it, without calling
+   * Balance(). pos must be a valid position in a non-empty deque. A full
+   * block splits (or grows while it is small); otherwise only later block
+   * starts move, through Shift().
+   */
+  template <class... Args>
+  void EmplaceAt(iterator &pos, Args&&... args) {
+    auto block_it = pos.block_it;
+    size_t offset = pos.offset, bi = pos.Bi();
+    bool relinked = false;
+    if (block_it->full()) {
+      T value(std::forward<Args>(args)...);  // args may refer to an element about to be relocated
+      if (block_it->count > block_size) {
+        size_t half = block_it->count / 2;
+        Split(block_it);
+        DirSplit(bi);
+        relinked = true;
+        if (sweep != kIdle && bi < sweep) ++sweep;
+        if (offset > half) {
+          offset -= half;
+          ++block_it;
+          ++bi;
+        }
+      } else {
+        block_it->reserve(block_it->cap * 2);
       }
-      else --item_it;
+      block_it->emplace(offset, std::move(value));
+    } else {
+      block_it->emplace(offset, std::forward<Args>(args)...);
+    }
+    total_size++;
 
-      return old;
+    if (relinked && !kTree) {
+      Reindex();
+      SJTU_DEQUE_WALK(insert_walk, BlockCount());
+    } else {
+      Shift(bi, 1);
+      SJTU_DEQUE_WALK(insert_walk, walked_);
     }
-    const_iterator &operator--() {
-      if(*this == outer->cend()) {
-        block_it = outer->blocks.get_tail();
-        item_it = block_it->items.get_tail();
-        return *this;
-      }     
+    pos = iterator(offset, bi, block_it, this);
+  }
 
-      if(block_it==outer->blocks.begin() && item_it==block_it->items.begin())
-        throw std::out_of_range("");
+  // remove the element at pos and leave pos on the one after it, without calling Balance()
+  void EraseAt(iterator &pos) {
+    auto block_it = pos.block_it;
+    size_t offset = pos.offset, bi = pos.Bi();
+    block_it->erase(offset);
+    total_size--;
 
-      if(item_it == block_it->items.end())
-        throw std::out_of_range("");
-            
-      if(item_it == block_it->items.begin()) {
-        --block_it;
-        item_it = block_it->items.get_tail();
+    if (block_it->count == 0) {
+      block_it = blocks.erase(block_it);
+      if (sweep != kIdle && bi < sweep) --sweep;
+      if (kTree) {
+        DirErase(bi);
+        SJTU_DEQUE_WALK(erase_walk, tree.depth());
+      } else {
+        Reindex();
+        SJTU_DEQUE_WALK(erase_walk, BlockCount());
       }
-      else --item_it;
-
-      return *this;
+    } else {
+      Shift(bi, static_cast<size_t>(-1));
+      SJTU_DEQUE_WALK(erase_walk, walked_);
     }
 
-    // *it
-    const T &operator*() const {return *item_it;}
-    // it->field
-    const T *operator->() const noexcept {return &(*item_it);}
-
-    /**
-     * check whether two iterators are the same (pointing to the same
-     * memory).
-     */
-    const bool operator==(const iterator &rhs) const {
-      return block_it == rhs.block_it && item_it == rhs.item_it;
-    }
-    const bool operator==(const const_iterator &rhs) const {
-      return block_it == rhs.block_it && item_it == rhs.item_it;
-    }
-    const bool operator!=(const iterator &rhs) const {
-      return block_it != rhs.block_it || item_it !=rhs.item_it;
+    if (block_it == blocks.end()) {
+      pos = end();
+      return;
     }
-    const bool operator!=(const const_iterator &rhs) const {
-      return block_it != rhs.block_it || item_it !=rhs.item_it;
+    if (offset == block_it->count && block_it != blocks.get_tail()) {  // the next element opens the next block
+      ++block_it;
+      ++bi;
+      offset = 0;
     }
-  };
+    pos = iterator(offset, bi, block_it, this);
+  }
+
+  iterator IteratorAt(size_t pos) {
+    if (blocks.empty()) return iterator(0, 0, nullptr, this);
+    size_t bi, offset;
+    block_iterator it = Locate(pos, bi, offset);
+    return iterator(offset, bi, it, this);
+  }
+  const_iterator ConstIteratorAt(size_t pos) const {
+    if (blocks.empty()) return const_iterator(0, 0, nullptr, this);
+    size_t bi, offset;
+    block_iterator it = Locate(pos, bi, offset);
+    return const_iterator(offset, bi, it, this);
+  }
 
-  deque(): total_size(0), block_size(4) {}
+public:
+  deque(): total_size(0), block_size(kInitialBlockSize) {}
   deque(const deque &other) {
-    clear(); 
-    total_size = other.total_size; 
-    block_size = other.block_size; 
+    CopyFrom(other);
+  }
 
-    for (auto it = other.blocks.begin(); it != other.blocks.end(); ++it) {
-      Block new_block;
-      for (auto item_it = it->items.begin(); item_it != it->items.end(); ++item_it) {
-        new_block.items.insert_tail(*item_it);
-      }
-      blocks.insert_tail(new_block); 
-    }
+  deque(deque &&other) noexcept {
+    swap(other);
+  }
+
+  template <class InputIt, class = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+  deque(InputIt first, InputIt last) {
+    insert(end(), first, last);
+  }
+
+  deque(size_t n, const T &value) {
+    insert(end(), n, value);
   }
 
   ~deque() {
-    clear(); 
+    clear();
+    delete[] dir;
   }
 
-  deque& operator=(const deque& other) const {
+  deque& operator=(const deque& other) {
     if (this == &other) return *this;
-    clear(); 
-    total_size = other.total_size; 
-    block_size = other.block_size;
-    for (auto it = other.blocks.begin(); it != other.blocks.end(); ++it) {
-      Block new_block;
-      for (auto item_it = it->items.begin(); item_it != it->items.end(); ++item_it) {
-        new_block.items.insert_tail(*item_it); 
+    deque copy(other);  // if an element copy throws, *this is untouched
+    swap(copy);
+
+    return *this;
+  }
+
+  deque& operator=(deque&& other) noexcept {
+    if (this == &other) return *this;
+    clear();
+    swap(other);
+
+    return *this;
+  }
+
+  /**
+   * opt in to copy-on-write: copies of this deque then share its block
+   * buffers, so a copy costs O(number of blocks), and a block is cloned
+   * the first time either side writes to it (non-const access included).
+   * Copies inherit the mode. Shared blocks are reference counted without
+   * atomics, so deques sharing blocks must stay on one thread. A mutable
+   * iterator unshares the block it enters; copying the deque invalidates
+   * the mutable iterators it already handed out.
+   */
+  void set_copy_on_write(bool on) { cow = on; }
+  bool copy_on_write() const { return cow; }
+
+  /**
+   * replace the contents with [first, last) or with n copies of value,
+   * built block by block at the final block size.
+   */
+  template <class InputIt, class = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+  void assign(InputIt first, InputIt last) {
+    clear();
+    insert(end(), first, last);
+  }
+
+  void assign(size_t n, const T &value) {
+    T copy(value);  // value may be one of the elements being cleared
+    clear();
+    CopySource src{copy, n};
+    InsertFrom(end(), src, n);
+  }
+
+  /**
+   * exchange contents with other in O(number of blocks): the chains,
+   * directories and buffer caches are swapped, never the elements.
+   */
+  void swap(deque &other) noexcept {
+    ++generation;
+    ++other.generation;
+    buffers.swap(other.buffers);
+    blocks.swap(other.blocks);
+    std::swap(total_size, other.total_size);
+    std::swap(block_size, other.block_size);
+    std::swap(dir, other.dir);
+    std::swap(dir_cap, other.dir_cap);
+    std::swap(dir_begin, other.dir_begin);
+    std::swap(dir_end, other.dir_end);
+    std::swap(origin, other.origin);
+    std::swap(head_base, other.head_base);
+    std::swap(lazy_from, other.lazy_from);
+    std::swap(lazy_delta, other.lazy_delta);
+    tree.swap(other.tree);
+    std::swap(head_lag, other.head_lag);
+    std::swap(sweep, other.sweep);
+    std::swap(cow, other.cow);
+    std::swap(dir_allocations, other.dir_allocations);
+    std::swap(rebalances, other.rebalances);
+    std::swap(resizes, other.resizes);
+#if SJTU_DEQUE_PROFILE
+    std::swap(profile_, other.profile_);
+#endif
+    AdoptBlocks();
+    other.AdoptBlocks();
+  }
+
+  /**
+   * move every element of other to the back of this deque, leaving other
+   * empty. The block chains are linked, not copied: the cost is
+   * O(number of blocks) plus at most one merge at the seam, and blocks
+   * sized for other's block_size are fixed lazily by later Balance()
+   * calls. Invalidates the iterators of both deques. Both must use
+   * allocators that compare equal.
+   */
+  void append(deque &&other) {
+    if (&other == this || other.empty()) return;
+    ++generation;
+    ++other.generation;
+    if (blocks.empty()) block_size = other.block_size;
+    block_iterator seam = blocks.get_tail();
+    size_t seam_bi = blocks.empty() ? 0 : BlockCount() - 1;
+    if (other.block_size != block_size) seam_bi = 0;  // other's blocks all have to be looked at
+    blocks.splice(blocks.end(), other.blocks);
+    total_size += other.total_size;
+    AdoptBlocks();
+    if (seam != blocks.end()) Merge(seam);
+    other.clear();
+    Reindex();
+    if (sweep == kIdle || sweep > seam_bi) sweep = seam_bi;
+    Balance();
+  }
+
+  /**
+   * cut the deque in front of its pos-th element and return the back
+   * part [pos, size()) as a new deque; this one keeps [0, pos). Only the
+   * block holding the cut is split, the blocks behind it change hands
+   * as they are, so the cost is O(number of blocks) plus half a block of
+   * element moves. Invalidates all iterators. throw if pos > size().
+   */
+  deque split_at(size_t pos) {
+    if (pos > total_size) throw std::out_of_range("");
+    deque rest;
+    if (pos == total_size) return rest;
+    ++generation;
+    rest.cow = cow;
+    if (pos == 0) {
+      rest.swap(*this);
+      return rest;
+    }
+    size_t bi, offset;
+    block_iterator at = Locate(pos, bi, offset);
+    at = Cut(at, offset);
+    size_t kept = offset == 0 ? bi : bi + 1;
+    rest.blocks.splice(rest.blocks.end(), blocks, at, blocks.end(), blocks.size() - kept);
+    rest.total_size = total_size - pos;
+    rest.block_size = block_size;
+    rest.AdoptBlocks();
+    rest.Reindex();
+    rest.sweep = 0;
+    total_size = pos;
+    Reindex();
+    if (sweep == kIdle || sweep >= kept) sweep = kept - 1;
+    Balance();
+    rest.Balance();
+    return rest;
+  }
+
+  /**
+   * adopt the buffers [first, last) as blocks, in order, without copying
+   * an element. Every capacity has to be a power of two the buffer pool
+   * can hold (with a fixed-capacity Policy, exactly that capacity), and
+   * every buffer must come from an Alloc equal to the deque's. Blocks far
+   * from the Policy's size are fixed lazily by later Balance() calls.
+   * throw std::out_of_range, before taking any buffer, if one does not
+   * qualify; once they have been checked the deque owns all of them, and
+   * frees them if it throws.
+   */
+  template <class ForwardIt>
+  deque(adopt_buffers_t, ForwardIt first, ForwardIt last) {
+    for (ForwardIt it = first; it != last; ++it) {
+      const deque_buffer<T> &b = *it;
+      if (b.data == nullptr || b.count > b.capacity || RoundUp(b.capacity) != b.capacity) {
+        throw std::out_of_range("");
+      }
+    }
+    try {
+      for (; first != last; ++first) {
+        const deque_buffer<T> &b = *first;
+        if (b.count == 0) {
+          buffers.deallocate(b.data, b.capacity);
+          continue;
+        }
+        blocks.emplace_tail(&buffers, b.data, b.capacity, b.count, typename Block::adopt_tag());
+        total_size += b.count;
       }
-      blocks.insert_tail(new_block);
+    } catch (...) {
+      for (; first != last; ++first) {
+        const deque_buffer<T> &b = *first;
+        for (size_t i = 0; i < b.count; ++i) b.data[i].~T();
+        buffers.deallocate(b.data, b.capacity);
+      }
+      throw;
     }
+    Anticipate(0);
+    Reindex();
+    sweep = 0;
+    Balance();
+  }
 
-    return *this;
+  // see deque_span: write(spans, n) is called once, with the header and every element
+  template <class Writer>
+  void serialize(Writer &&write) const {
+    const bool raw = std::is_trivially_copyable<T>::value;
+    deque_wire_header header = {deque_wire_header::kMagic, sizeof(T), raw, total_size};
+    SerializeElements(write, header, std::integral_constant<bool, raw>());
+  }
+
+  /**
+   * replace the contents with a deque that serialize() wrote, pulled
+   * through read(dest, bytes). throw std::runtime_error if the header is
+   * not one for this T; if read (or an element constructor) throws, the
+   * deque is left as it was.
+   */
+  template <class Reader>
+  void deserialize(Reader &&read) {
+    const bool raw = std::is_trivially_copyable<T>::value;
+    deque_wire_header header;
+    read(static_cast<void *>(&header), sizeof(header));
+    if (header.magic != deque_wire_header::kMagic || header.raw != raw || header.element_size != sizeof(T)) {
+      throw std::runtime_error("deque: not a serialized deque of this element type");
+    }
+    deque result;
+    result.cow = cow;
+    ReadSource<typename std::remove_reference<Reader>::type, raw> src{read, static_cast<size_t>(header.count)};
+    result.Anticipate(src.n);
+    result.FillBefore(result.blocks.end(), src);
+    result.Reindex();
+    result.Balance();
+    swap(result);
   }
 
   T& at(const size_t& pos) {
     if (pos >= total_size) {
       throw std::out_of_range("");
     }
-
-    size_t current_pos = 0;
-    for (auto it = blocks.begin(); it != blocks.end(); ++it) {
-      if (current_pos + it->items.size() > pos) {
-        auto item_it = it->items.begin();
-        std::advance(item_it, pos - current_pos);  // 找到正确的项
-        return *item_it;
-      }
-      current_pos += it->items.size();
-    }
-    throw std::out_of_range("");
+    size_t bi, offset;
+    block_iterator it = Locate(pos, bi, offset);
+    SJTU_DEQUE_WALK(at_walk, walked_);
+    return (*it)[offset];
   }
   const T &at(const size_t &pos) const {
     if (pos >= total_size) {
       throw std::out_of_range("");
     }
-
-    size_t current_pos = 0;
-    for (auto it = blocks.begin(); it != blocks.end(); ++it) {
-      if (current_pos + it->items.size() > pos) {
-        auto item_it = it->items.begin();
-        std::advance(item_it, pos - current_pos);  // 找到正确的项
-        return *item_it;
-      }
-      current_pos += it->items.size();
-    }
-    throw std::out_of_range("");
+    size_t bi, offset;
+    const Block &block = *Locate(pos, bi, offset);  // a read must not unshare the block
+    SJTU_DEQUE_WALK(at_walk, walked_);
+    return block[offset];
   }
   T &operator[](const size_t &pos) {
     return at(pos);
@@ -998,52 +3050,114 @@ public:
     if (blocks.empty()) {
       throw std::out_of_range("");
     }
-    return blocks.front().items.front();
+    return blocks.front()[0];
   }
   const T &back() const {
     if (blocks.empty()) {
       throw std::out_of_range("");
     }
-    return blocks.back().items.back();  
+    return blocks.back()[blocks.back().count - 1];
   }
 
   iterator begin() {
     if (blocks.empty()) {
-      return iterator(nullptr, nullptr, this);
+      return iterator(0, 0, nullptr, this);
     }
-    return iterator(blocks.begin()->items.begin(), blocks.begin(), this);
+    return iterator(0, 0, blocks.begin(), this);
   }
   const_iterator cbegin() const {
     if (blocks.empty()) {
-      return const_iterator(nullptr, nullptr, this);
+      return const_iterator(0, 0, nullptr, this);
     }
-    return const_iterator(blocks.begin()->items.begin(), blocks.begin(), this);
+    return const_iterator(0, 0, blocks.begin(), this);
   }
 
   iterator end() {
     if (blocks.empty()) {
-      return iterator(nullptr, nullptr, this);
+      return iterator(0, 0, nullptr, this);
     }
-    return iterator(blocks.back().items.end(), blocks.get_tail(), this);
+    return iterator(blocks.back().count, BlockCount() - 1, blocks.get_tail(), this);
   }
 
   const_iterator cend() const {
     if (blocks.empty()) {
-      return const_iterator(nullptr, nullptr, this);
+      return const_iterator(0, 0, nullptr, this);
     }
-    return const_iterator(blocks.back().items.end(), blocks.get_tail(), this);   
+    return const_iterator(blocks.back().count, BlockCount() - 1, blocks.get_tail(), this);
   }
 
   bool empty() const { return total_size == 0; }
   size_t size() const { return total_size; }
 
-  void clear() {
+  deque_memory_stats memory_stats() const {
+    deque_memory_stats stats;
+    size_t slots = 0;
     for (auto it = blocks.begin(); it != blocks.end(); ++it) {
-      it->items.clear();
-    }
+      const Block &block = *it;
+      slots += block.cap;
+      if (stats.blocks == 0 || block.count < stats.min_fill) stats.min_fill = block.count;
+      if (block.count > stats.max_fill) stats.max_fill = block.count;
+      ++stats.blocks;
+    }
+    stats.bytes_allocated = slots * sizeof(T) + buffers.cached_bytes() + blocks.pool_bytes() +
+                            dir_cap * sizeof(Entry) + tree.bytes();
+    stats.element_bytes = total_size * sizeof(T);
+    stats.avg_fill = slots ? static_cast<double>(total_size) / slots : 0;
+    stats.block_size = block_size;
+    stats.allocations = buffers.allocations() + blocks.pool_allocations() + dir_allocations + tree.allocations();
+    stats.rebalances = rebalances;
+    stats.resizes = resizes;
+    return stats;
+  }
+
+#if SJTU_DEQUE_PROFILE
+  // the instrumentation counters, from construction or the last reset_profile() on
+  const deque_profile &profile() const { return profile_; }
+  void reset_profile() { profile_ = deque_profile(); }
+#endif
+
+  /**
+   * compact the chain: neighbouring blocks are merged while the result
+   * stays within 2 * block_size, every buffer is cut to the smallest
+   * capacity holding its elements (a no-op for fixed-capacity policies),
+   * and cached buffers and spare directory room go back to the
+   * allocator. Invalidates all iterators. O(n).
+   */
+  void shrink_to_fit() {
+    ++generation;
+    for (auto it = blocks.begin(); it != blocks.end();) {
+      auto next = it;
+      ++next;
+      if (next != blocks.end() && it->count + next->count <= block_size * 2) {
+        it->reserve(RoundUp(it->count + next->count));
+        next->move_back_to(*it, next->count);
+        blocks.erase(next);
+        continue;
+      }
+      it->shrink(RoundUp(it->count));
+      it = next;
+    }
+    buffers.release();
+    delete[] dir;
+    dir = nullptr;
+    dir_cap = 0;
+    Reindex();
+    if (sweep != kIdle) sweep = 0;  // block indices moved
+  }
+
+  void clear() {
+    ++generation;
     blocks.clear();
+    buffers.release();
     total_size = 0;
-    block_size = 4;
+    block_size = kInitialBlockSize;
+    sweep = kIdle;
+    dir_begin = dir_end = dir_cap / 2;
+    origin = 0;
+    lazy_from = dir_begin;
+    lazy_delta = 0;
+    tree.clear();
+    head_lag = 0;
   }
 
 
@@ -1052,113 +3166,403 @@ public:
    * return an iterator pointing to the inserted value.
    * throw if the iterator is invalid or it points to a wrong place.
    */
-  
+
   iterator insert(iterator pos, const T& value) {
+    return emplace(pos, value);
+  }
+
+  iterator insert(iterator pos, T&& value) {
+    return emplace(pos, std::move(value));
+  }
+
+  /**
+   * insert [first, last) or n copies of value before pos: the block at pos
+   * is cut once, whole blocks are built in between and the deque is
+   * rebalanced once. return an iterator to the first inserted element.
+   */
+  template <class InputIt, class = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+  iterator insert(iterator pos, InputIt first, InputIt last) {
+    size_t n = Distance(first, last, typename detail::iterator_category<InputIt>::type());
+    RangeSource<InputIt> src{first, last};
+    return InsertFrom(pos, src, n);
+  }
+
+  iterator insert(iterator pos, size_t n, const T &value) {
+    T copy(value);  // value may live in the block that is about to be cut
+    CopySource src{copy, n};
+    return InsertFrom(pos, src, n);
+  }
+
+  /**
+   * construct an element in place before pos.
+   * return an iterator pointing to the new element, built from the block
+   * the element went into rather than looked up again.
+   */
+  template <class... Args>
+  iterator emplace(iterator pos, Args&&... args) {
     if (blocks.empty()) {
       if(pos!=end()) throw std::out_of_range("");
-      blocks.insert_tail(Block{}); 
-      blocks.back().items.insert_tail(value);
-      total_size++;
-      return iterator(blocks.back().items.begin(), blocks.get_tail(), this);
+      emplace_back(std::forward<Args>(args)...);
+      return begin();
     }
 
-    if (pos.block_it == nullptr) { 
+    if (pos.block_it == nullptr || pos.outer != this) {
       throw std::out_of_range("");
     }
 
-    size_t dis = pos - (this->begin());
+    size_t dis = pos.index();
     if(dis>total_size) throw std::out_of_range("");
-    auto block_it = pos.block_it;  
-    auto item_it = block_it->items.insert(pos.item_it, value); 
-    total_size++;  
+    ++generation;
+    EmplaceAt(pos, std::forward<Args>(args)...);
+    if (Balance()) return IteratorAt(dis);  // a split or merge moved the element
 
-    Balance(); 
-    
-    block_it = blocks.begin();
-    while(dis >= block_it->items.size()){
-      dis -= block_it->items.size();   
-      if(block_it == blocks.get_tail()) break;
-      ++block_it;
-    }
+    return pos;
+  }
 
-    item_it = block_it->items.begin();
-    std::advance(item_it, dis);
+  /**
+   * insert [first, last) before pos one element at a time, keeping a
+   * cursor behind the last inserted element, and rebalance once at the
+   * end. For a few elements into the same block or its neighbours this
+   * is cheaper than insert(pos, first, last), which cuts the block and
+   * builds new ones; for long ranges use that. If an element constructor
+   * throws, the elements inserted so far stay. return an iterator to the
+   * first inserted element.
+   */
+  template <class InputIt, class = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+  iterator insert_many_at(iterator pos, InputIt first, InputIt last) {
+    if (blocks.empty() || first == last) return insert(pos, first, last);
+    if (pos.block_it == nullptr || pos.outer != this) throw std::out_of_range("");
+    size_t dis = pos.index();
+    if (dis > total_size) throw std::out_of_range("");
+
+    ++generation;
+    for (; first != last; ++first) {
+      EmplaceAt(pos, *first);
+      ++pos.offset;  // the cursor moves behind the new element
+      pos.Sync();
+    }
+    Balance();
+    return IteratorAt(dis);
+  }
 
-    return iterator(item_it, block_it, this);  // 返回指向插入位置的 iterator
+  iterator insert_many_at(iterator pos, std::initializer_list<T> values) {
+    return insert_many_at(pos, values.begin(), values.end());
   }
 
 
   iterator erase(iterator pos) {
-    if (pos.block_it == nullptr) {
+    if (pos.block_it == nullptr || pos.outer != this) {
       throw std::out_of_range("Invalid iterator");
     }
 
-    size_t dis = pos - (this->begin());
+    size_t dis = pos.index();
     if(dis>=total_size) throw std::out_of_range("");
+    ++generation;
+    EraseAt(pos);
 
-    auto block_it = pos.block_it;
-    auto item_it = block_it->items.erase(pos.item_it); 
-    total_size--; 
-
-    if (block_it->items.empty()) {
-      blocks.erase(block_it); 
-    }
-
+    bool relinked = Balance();
     if(empty() || dis==total_size)
       return end();
 
-    Balance();     
-    
-    block_it = blocks.begin();
-    while(dis >= block_it->items.size()){
-      dis -= block_it->items.size();
-      if(block_it == blocks.get_tail()) break;
-      ++block_it;
-    }
+    if (relinked) return IteratorAt(dis);
 
-    item_it = block_it->items.begin();
-    std::advance(item_it, dis);
+    return pos;
+  }
 
-    return iterator(item_it, block_it, this); 
+  /**
+   * remove [first, last): whole blocks in between are dropped, the two end
+   * blocks are trimmed in place. return an iterator to the element after.
+   */
+  iterator erase(iterator first, iterator last) {
+    if (first.outer != this || last.outer != this) throw std::out_of_range("Invalid iterator");
+    if (blocks.empty()) {
+      if (first.block_it != nullptr || last.block_it != nullptr) throw std::out_of_range("");
+      return end();
+    }
+    if (first.block_it == nullptr || last.block_it == nullptr) throw std::out_of_range("");
+
+    size_t from = first.index(), to = last.index();
+    if (from > to || to > total_size) throw std::out_of_range("");
+    if (from == to) return IteratorAt(from);
+    ++generation;
+
+    auto fb = first.block_it, lb = last.block_it;
+    if (fb == lb) {
+      fb->erase(first.offset, to - from);
+    } else {
+      fb->erase(first.offset, fb->count - first.offset);
+      auto it = fb;
+      ++it;
+      while (it != lb) it = blocks.erase(it);
+      lb->erase(0, last.offset);
+      if (lb->count == 0) blocks.erase(lb);
+    }
+    total_size -= to - from;
+    if (fb->count == 0) blocks.erase(fb);
+    else Merge(fb);
+
+    if (sweep != kIdle && sweep > first.Bi()) sweep = first.Bi();
+    Reindex();
+    Balance();
+    if (from == total_size) return end();
+    return IteratorAt(from);
   }
 
   void push_back(const T &value) {
-    if (blocks.empty() || blocks.back().items.size() >= block_size) {
-      blocks.insert_tail(Block{});
+    emplace_back(value);
+  }
+  void push_back(T &&value) {
+    emplace_back(std::move(value));
+  }
+  template <class... Args>
+  void emplace_back(Args&&... args) {
+    ++generation;
+    if (blocks.empty() || blocks.back().count >= block_size || blocks.back().full()) {
+      blocks.emplace_tail(&buffers, NewCapacity());
+      try {
+        blocks.back().emplace_back(std::forward<Args>(args)...);
+      } catch (...) {
+        blocks.delete_tail();
+        throw;
+      }
+      if (kTree) {
+        size_t n = tree.size();
+        if (n) SetCount(n - 1, NodeAt(n - 1)->count);  // no longer the tail
+        tree.insert(n, blocks.get_tail(), 1);
+      } else if (dir_end == dir_cap || BlockCount() == 0) {
+        Reindex();
+      } else {
+        SetFirst(dir_end, First(dir_end - 1) + dir[dir_end - 1].node->count);
+        dir[dir_end].node = blocks.get_tail();
+        ++dir_end;
+      }
+    } else {
+      blocks.back().emplace_back(std::forward<Args>(args)...);
     }
-    blocks.back().items.insert_tail(value);
     total_size++;
     Balance();
   }
   void pop_back() {
     if (empty()) throw std::out_of_range("");
+    ++generation;
 
-    blocks.back().items.delete_tail();
-    if (blocks.back().items.empty())
+    blocks.back().pop_back();
+    if (blocks.back().count == 0) {
       blocks.delete_tail();
+      if (kTree) DirErase(tree.size() - 1);
+      else --dir_end;
+    }
     total_size--;
     Balance();
   }
 
   void push_front(const T &value) {
-    if (blocks.empty() || blocks.front().items.size() >= block_size) {
-      blocks.insert_head(Block{});
+    emplace_front(value);
+  }
+  void push_front(T &&value) {
+    emplace_front(std::move(value));
+  }
+  template <class... Args>
+  void emplace_front(Args&&... args) {
+    ++generation;
+    if (blocks.empty() || blocks.front().count >= block_size || blocks.front().full()) {
+      blocks.emplace_head(&buffers, NewCapacity());
+      try {
+        blocks.front().emplace_front(std::forward<Args>(args)...);
+      } catch (...) {
+        blocks.delete_head();
+        throw;
+      }
+      --head_base;
+      if (sweep != kIdle) ++sweep;
+      if (kTree) {
+        --origin;
+        if (tree.size()) SetCount(0, NodeAt(0)->count);
+        tree.insert(0, blocks.begin(), 1);
+      } else if (dir_begin == 0 || BlockCount() == 0) {
+        --origin;
+        Reindex();
+      } else {
+        --dir_begin;
+        SetFirst(dir_begin, First(dir_begin + 1) - 1);
+        dir[dir_begin].node = blocks.begin();
+        --origin;
+      }
+    } else {
+      blocks.front().emplace_front(std::forward<Args>(args)...);
+      if (kTree) --head_lag;
+      else --dir[dir_begin].first;
+      --origin;
     }
-    blocks.front().items.insert_head(value);
     total_size++;
     Balance();
   }
   void pop_front() {
     if (empty()) throw std::out_of_range("");
+    ++generation;
 
-    blocks.front().items.delete_head();
-    if (blocks.front().items.empty())
+    blocks.front().pop_front();
+    if (kTree) ++head_lag;
+    else ++dir[dir_begin].first;
+    ++origin;
+    if (blocks.front().count == 0) {
       blocks.delete_head();
+      ++head_base;
+      if (kTree) DirErase(0);
+      else ++dir_begin;
+      if (sweep != kIdle && sweep > 0) --sweep;
+    }
     total_size--;
     Balance();
   }
+
+  /**
+   * Batch end operations, for producers and consumers that move many
+   * elements at a time. They work a block at a time and call Balance()
+   * once per batch instead of once per element; with trivially copyable
+   * elements and a plain pointer as the range, each block piece is one
+   * memcpy.
+   *
+   * push_back_n / push_front_n add the count elements from first on at
+   * that end, in order (as insert(end() / begin(), ...) would). If an
+   * element constructor throws, the elements already added stay.
+   */
+  template <class InputIt>
+  void push_back_n(InputIt first, size_t count) {
+    if (count == 0) return;
+    ++generation;
+    Anticipate(count);
+    size_t before = blocks.size();
+    CountedSource<InputIt> src{first, count};
+    FillBefore(blocks.end(), src);  // tops the tail block up first
+    DirAppend(blocks.size() - before);
+    Balance();
+  }
+  template <class InputIt>
+  void push_front_n(InputIt first, size_t count) {
+    if (count == 0) return;
+    ++generation;
+    Anticipate(count);
+    if (!blocks.empty()) {
+      Block &head = blocks.front();
+      size_t limit = block_size < head.width() ? block_size : head.width();
+      if (head.count < limit && count <= limit - head.count) {  // fits in front of the head block
+        PrependTo(head, first, count, RawPointer<InputIt>());
+        if (kTree) head_lag -= count;
+        else dir[dir_begin].first -= count;
+        origin -= count;
+        total_size += count;
+        Balance();
+        return;
+      }
+    }
+    size_t before = blocks.size();
+    CountedSource<InputIt> src{first, count};
+    try {
+      FillBefore(blocks.begin(), src);
+    } catch (...) {
+      origin -= count - src.n;  // FillBefore reindexed before origin covered what it built
+      head_base -= blocks.size() - before;
+      Reindex();
+      throw;
+    }
+    origin -= count;
+    size_t added = blocks.size() - before;
+    head_base -= added;
+    if (sweep != kIdle) sweep += added;
+    DirPrepend(added, count);
+    Balance();
+  }
+
+  /**
+   * pop_front_n / pop_back_n remove the first / last count elements and
+   * write them to out in deque order, returning the advanced out; throw
+   * std::out_of_range if count > size(). The overloads without out only
+   * drop them. If writing to out throws, the elements already written
+   * are removed and the rest stay in the deque (the one being written
+   * may be moved from).
+   */
+  template <class OutputIt>
+  OutputIt pop_front_n(size_t count, OutputIt out) {
+    if (count > total_size) throw std::out_of_range("");
+    if (count == 0) return out;
+    ++generation;
+    while (count) {
+      Block &head = blocks.front();
+      size_t k = count < head.count ? count : head.count, done = 0;
+      try {
+        out = TakeFrom(head, 0, k, out, done, RawPointer<OutputIt>());
+      } catch (...) {
+        if (done) DropFront(done);
+        Balance();
+        throw;
+      }
+      DropFront(k);
+      count -= k;
+    }
+    Balance();
+    return out;
+  }
+  void pop_front_n(size_t count) {
+    if (count > total_size) throw std::out_of_range("");
+    if (count == 0) return;
+    ++generation;
+    while (count) {
+      size_t k = count < blocks.front().count ? count : blocks.front().count;
+      DropFront(k);
+      count -= k;
+    }
+    Balance();
+  }
+
+  template <class OutputIt>
+  OutputIt pop_back_n(size_t count, OutputIt out) {
+    if (count > total_size) throw std::out_of_range("");
+    if (count == 0) return out;
+    ++generation;
+    size_t start = total_size - count, written = 0, bi, offset;
+    block_iterator it = Locate(start, bi, offset);
+    try {
+      for (; it != blocks.end(); ++it, offset = 0)
+        out = TakeFrom(*it, offset, it->count - offset, out, written, RawPointer<OutputIt>());
+    } catch (...) {
+      // what was written is the front of the suffix, with the unwritten rest behind it
+      if (written) erase(IteratorAt(start), IteratorAt(start + written));
+      throw;
+    }
+    pop_back_n(count);
+    return out;
+  }
+  void pop_back_n(size_t count) {
+    if (count > total_size) throw std::out_of_range("");
+    if (count == 0) return;
+    ++generation;
+    while (count) {
+      size_t k = count < blocks.back().count ? count : blocks.back().count;
+      DropBack(k);
+      count -= k;
+    }
+    Balance();
+  }
+
+  // move every element to out, front to back, leaving the deque empty
+  template <class OutputIt>
+  OutputIt drain_into(OutputIt out) {
+    return pop_front_n(total_size, out);
+  }
 };
 
+// the elements of a followed by those of b, without copying them (see deque::append)
+template <class T, class Alloc, class Policy>
+deque<T, Alloc, Policy> concat(deque<T, Alloc, Policy> &&a, deque<T, Alloc, Policy> &&b) {
+  deque<T, Alloc, Policy> result(std::move(a));
+  result.append(std::move(b));
+  return result;
+}
+
+#undef SJTU_DEQUE_TIME
+#undef SJTU_DEQUE_WALK
+
 } // namespace sjtu
 
 #endif
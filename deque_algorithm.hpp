@@ -0,0 +1,216 @@
+#ifndef SJTU_DEQUE_ALGORITHM_HPP
+#define SJTU_DEQUE_ALGORITHM_HPP
+
+#include "deque.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <numeric>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace sjtu {
+
+/**
+ * Segmented algorithms. A deque iterator range is a run of contiguous
+ * pieces of block storage (a ring buffer splits into at most two pieces
+ * per block). These overloads hand each piece to the plain pointer
+ * version of the algorithm, so the inner loop is a flat array loop the
+ * compiler can vectorize, instead of a two-level iterator step.
+ * For any other iterator type they forward to the std:: algorithm.
+ * Call them qualified (sjtu::find), so ADL does not also pick std::find.
+ */
+
+namespace detail {
+// true for iterators that expose their storage as segments (deque iterators)
+template <class It, class = void>
+struct is_segmented : std::false_type {};
+template <class It>
+struct is_segmented<It, typename make_void<typename It::segment_pointer>::type> : std::true_type {};
+
+// number of elements in [first, last); throws for a reversed or foreign range
+template <class It>
+std::size_t segment_length(const It &first, const It &last) {
+  std::ptrdiff_t n = last - first;
+  if (n < 0) throw std::out_of_range("");
+  return static_cast<std::size_t>(n);
+}
+
+// move it forward by run elements, all inside its current segment
+template <class It>
+void skip_in_segment(It &it, std::size_t run) {
+  it.offset += run;
+  it.cur += run;
+  if (it.cur == it.seg_end) it.Advance();
+}
+
+// find kernels for one contiguous piece. A search for an integer of the
+// element's own type compares whole vectors of 4-byte lanes at a time
+// (AVX2, SSE2 or NEON, whichever the target has) or uses memchr for
+// bytes; every other combination is a plain std::find.
+template <class P, class V>
+struct raw_find {
+  typedef typename std::remove_cv<typename std::remove_pointer<P>::type>::type element;
+  static constexpr std::size_t width =
+      std::is_integral<element>::value && std::is_same<element, V>::value ? sizeof(element) : 0;
+};
+
+template <class P, class V>
+typename std::enable_if<raw_find<P, V>::width == 1, P>::type
+find_in_segment(P b, P e, const V &value) {
+  const void *hit = std::memchr(b, static_cast<unsigned char>(value), e - b);
+  return hit ? b + (static_cast<const unsigned char *>(hit) - reinterpret_cast<const unsigned char *>(b)) : e;
+}
+
+template <class P, class V>
+typename std::enable_if<raw_find<P, V>::width == 4, P>::type
+find_in_segment(P b, P e, const V &value) {
+  std::int32_t key;
+  std::memcpy(&key, &value, sizeof(key));
+#if defined(__AVX2__)
+  __m256i k = _mm256_set1_epi32(key);
+  for (; e - b >= 8; b += 8) {
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b));
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, k))));
+    if (mask) return b + __builtin_ctz(mask);
+  }
+#elif defined(__SSE2__)
+  __m128i k = _mm_set1_epi32(key);
+  for (; e - b >= 4; b += 4) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b));
+    unsigned mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, k))));
+    if (mask) return b + __builtin_ctz(mask);
+  }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+  uint32x4_t k = vdupq_n_u32(static_cast<std::uint32_t>(key));
+  for (; e - b >= 4; b += 4) {
+    uint32x4_t eq = vceqq_u32(vld1q_u32(reinterpret_cast<const std::uint32_t *>(b)), k);
+    if (vmaxvq_u32(eq)) break;  // the scalar tail below pins down the lane
+  }
+#endif
+  return std::find(b, e, value);
+}
+
+template <class P, class V>
+typename std::enable_if<raw_find<P, V>::width != 1 && raw_find<P, V>::width != 4, P>::type
+find_in_segment(P b, P e, const V &value) {
+  return std::find(b, e, value);
+}
+} // namespace detail
+
+/**
+ * call f(begin, end) once for every contiguous piece of [first, last),
+ * in order. return f.
+ */
+template <class It, class F>
+typename std::enable_if<detail::is_segmented<It>::value, F>::type
+for_each_segment(It first, It last, F f) {
+  std::size_t n = detail::segment_length(first, last);
+  while (n) {
+    std::size_t run = first.seg_end - first.cur;
+    if (run > n) run = n;
+    f(first.cur, first.cur + run);
+    n -= run;
+    if (n) detail::skip_in_segment(first, run);
+  }
+  return f;
+}
+
+template <class It, class V>
+typename std::enable_if<detail::is_segmented<It>::value, It>::type
+find(It first, It last, const V &value) {
+  std::size_t n = detail::segment_length(first, last);
+  while (n) {
+    std::size_t run = first.seg_end - first.cur;
+    if (run > n) run = n;
+    typename It::segment_pointer hit = detail::find_in_segment(first.cur, first.cur + run, value);
+    if (hit != first.cur + run) {
+      first.offset += hit - first.cur;
+      first.cur = hit;
+      return first;
+    }
+    n -= run;
+    if (n) detail::skip_in_segment(first, run);
+  }
+  return last;
+}
+
+template <class It, class V>
+typename std::enable_if<!detail::is_segmented<It>::value, It>::type
+find(It first, It last, const V &value) {
+  return std::find(first, last, value);
+}
+
+template <class It, class Out>
+typename std::enable_if<detail::is_segmented<It>::value, Out>::type
+copy(It first, It last, Out out) {
+  typedef typename It::segment_pointer pointer;
+  for_each_segment(first, last, [&out](pointer b, pointer e) { out = std::copy(b, e, out); });
+  return out;
+}
+
+template <class It, class Out>
+typename std::enable_if<!detail::is_segmented<It>::value, Out>::type
+copy(It first, It last, Out out) {
+  return std::copy(first, last, out);
+}
+
+template <class It, class V>
+typename std::enable_if<detail::is_segmented<It>::value>::type
+fill(It first, It last, const V &value) {
+  typedef typename It::segment_pointer pointer;
+  for_each_segment(first, last, [&value](pointer b, pointer e) { std::fill(b, e, value); });
+}
+
+template <class It, class V>
+typename std::enable_if<!detail::is_segmented<It>::value>::type
+fill(It first, It last, const V &value) {
+  std::fill(first, last, value);
+}
+
+template <class It, class V, class Op>
+typename std::enable_if<detail::is_segmented<It>::value, V>::type
+accumulate(It first, It last, V init, Op op) {
+  typedef typename It::segment_pointer pointer;
+  for_each_segment(first, last, [&](pointer b, pointer e) { init = std::accumulate(b, e, std::move(init), op); });
+  return init;
+}
+
+template <class It, class V, class Op>
+typename std::enable_if<!detail::is_segmented<It>::value, V>::type
+accumulate(It first, It last, V init, Op op) {
+  return std::accumulate(first, last, std::move(init), op);
+}
+
+template <class It, class V>
+V accumulate(It first, It last, V init) {
+  return sjtu::accumulate(first, last, std::move(init), std::plus<>());
+}
+
+template <class It, class Pred>
+typename std::enable_if<detail::is_segmented<It>::value, std::ptrdiff_t>::type
+count_if(It first, It last, Pred pred) {
+  typedef typename It::segment_pointer pointer;
+  std::ptrdiff_t count = 0;
+  for_each_segment(first, last, [&](pointer b, pointer e) { count += std::count_if(b, e, pred); });
+  return count;
+}
+
+template <class It, class Pred>
+typename std::enable_if<!detail::is_segmented<It>::value,
+                        typename std::iterator_traits<It>::difference_type>::type
+count_if(It first, It last, Pred pred) {
+  return std::count_if(first, last, pred);
+}
+
+} // namespace sjtu
+
+#endif
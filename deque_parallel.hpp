@@ -0,0 +1,312 @@
+#ifndef SJTU_DEQUE_PARALLEL_HPP
+#define SJTU_DEQUE_PARALLEL_HPP
+
+#include "deque_algorithm.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace sjtu {
+
+/**
+ * Parallel bulk algorithms. A range is cut into sub-ranges (for a deque,
+ * at block boundaries, so no block is shared by two tasks) and the
+ * sub-ranges are handed to a process-wide thread pool; the calling
+ * thread works too. Inside a task each sub-range runs the ordinary
+ * sequential algorithm, block by block.
+ *
+ * Iterators must be random access. f / op may run concurrently on
+ * different elements, so they must not share unsynchronised state; an
+ * exception from any of them is rethrown by the call (other tasks still
+ * run to completion). A parallel algorithm called from inside a task
+ * runs sequentially on that thread.
+ */
+namespace parallel {
+
+namespace detail {
+
+class pool {
+public:
+  static pool &instance() {
+    static pool p;
+    return p;
+  }
+
+  pool(const pool &) = delete;
+  pool &operator=(const pool &) = delete;
+
+  ~pool() { resize(1); }
+
+  // threads taking part in a run, the caller included
+  std::size_t size() const { return threads.load(); }
+
+  void resize(std::size_t count) {
+    if (count == 0) count = 1;
+    std::lock_guard<std::mutex> lock(run_lock);
+    {
+      std::lock_guard<std::mutex> state(m);
+      stop = true;
+    }
+    wake.notify_all();
+    for (std::thread &t : workers) t.join();
+    workers.clear();
+    stop = false;
+    for (std::size_t i = 1; i < count; ++i) workers.emplace_back([this] { Work(); });
+    threads.store(count);
+  }
+
+  // call job(i) for every i in [0, n), spread over the pool; returns when all are done
+  void run(std::size_t n, const std::function<void(std::size_t)> &f) {
+    if (n == 0) return;
+    if (inside() || n == 1) {
+      for (std::size_t i = 0; i < n; ++i) f(i);
+      return;
+    }
+    std::lock_guard<std::mutex> lock(run_lock);
+    {
+      std::unique_lock<std::mutex> state(m);
+      idle.wait(state, [this] { return active == 0; });  // stragglers of the previous run
+      job = &f;
+      total = n;
+      next.store(0);
+      finished = 0;
+      error = nullptr;
+      ++generation;
+    }
+    wake.notify_all();
+    inside() = true;
+    Drain();
+    inside() = false;
+    std::unique_lock<std::mutex> state(m);
+    idle.wait(state, [this] { return finished == total; });
+    job = nullptr;
+    if (error) std::rethrow_exception(error);
+  }
+
+private:
+  std::mutex run_lock;  // one run (or resize) at a time
+  std::mutex m;
+  std::condition_variable wake, idle;
+  std::vector<std::thread> workers;
+  std::atomic<std::size_t> threads{1};
+  const std::function<void(std::size_t)> *job = nullptr;
+  std::size_t total = 0, finished = 0, active = 0;
+  std::atomic<std::size_t> next{0};
+  unsigned long long generation = 0;
+  bool stop = false;
+  std::exception_ptr error;
+
+  pool() { resize(std::thread::hardware_concurrency()); }
+
+  static bool &inside() {
+    static thread_local bool flag = false;
+    return flag;
+  }
+
+  void Drain() {
+    for (std::size_t i; (i = next.fetch_add(1)) < total;) {
+      try {
+        (*job)(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> state(m);
+        if (!error) error = std::current_exception();
+      }
+      std::lock_guard<std::mutex> state(m);
+      if (++finished == total) idle.notify_all();
+    }
+  }
+
+  void Work() {
+    inside() = true;
+    std::unique_lock<std::mutex> state(m);
+    unsigned long long seen = generation;
+    while (true) {
+      wake.wait(state, [&] { return stop || generation != seen; });
+      if (stop) return;
+      seen = generation;
+      ++active;
+      state.unlock();
+      Drain();
+      state.lock();
+      if (--active == 0) idle.notify_all();
+    }
+  }
+};
+
+// offsets 0 = o_0 < o_1 < ... < o_k = n of about parts pieces, on block boundaries when segmented
+template <class It>
+std::vector<std::size_t> cut(It first, It last, std::size_t parts, std::true_type) {
+  std::size_t n = sjtu::detail::segment_length(first, last);
+  std::size_t target = n / parts + 1, at = 0, since = 0;
+  std::vector<std::size_t> offsets(1, 0);
+  typedef typename It::segment_pointer pointer;
+  sjtu::for_each_segment(first, last, [&](pointer b, pointer e) {
+    std::size_t len = e - b;
+    at += len;
+    since += len;
+    if (since >= target) {  // a piece never ends inside a block
+      offsets.push_back(at);
+      since = 0;
+    }
+  });
+  if (offsets.back() != n) offsets.push_back(n);
+  return offsets;
+}
+
+template <class It>
+std::vector<std::size_t> cut(It first, It last, std::size_t parts, std::false_type) {
+  std::size_t n = last - first;
+  if (parts > n) parts = n;
+  std::vector<std::size_t> offsets(1, 0);
+  if (n == 0) return offsets;
+  for (std::size_t i = 1; i <= parts; ++i) offsets.push_back(n / parts * i + std::min(i, n % parts));
+  return offsets;
+}
+
+template <class It>
+std::vector<std::size_t> cut(It first, It last, std::size_t parts) {
+  return cut(first, last, parts, sjtu::detail::is_segmented<It>());
+}
+
+/**
+ * first + o for every offset o, built on the calling thread: building a
+ * deque iterator may un-share a copy-on-write block, which must not
+ * race with a task working on that block
+ */
+template <class It>
+std::vector<It> bounds(It first, const std::vector<std::size_t> &at) {
+  std::vector<It> its;
+  its.reserve(at.size());
+  for (std::size_t o : at) its.push_back(first + typename std::iterator_traits<It>::difference_type(o));
+  return its;
+}
+
+// f(b, e) on every contiguous piece of [first, last), or once on the whole range
+template <class It, class F>
+typename std::enable_if<sjtu::detail::is_segmented<It>::value>::type each_piece(It first, It last, F f) {
+  sjtu::for_each_segment(first, last, f);
+}
+template <class It, class F>
+typename std::enable_if<!sjtu::detail::is_segmented<It>::value>::type each_piece(It first, It last, F f) {
+  f(first, last);
+}
+
+// tasks per thread, so that a slow task does not leave the others idle
+const std::size_t kSlack = 4;
+
+} // namespace detail
+
+// threads the algorithms use (the caller included); defaults to the hardware concurrency
+inline std::size_t thread_count() { return detail::pool::instance().size(); }
+inline void set_thread_count(std::size_t n) { detail::pool::instance().resize(n); }
+
+template <class It, class F>
+void for_each(It first, It last, F f) {
+  std::vector<It> its = detail::bounds(first, detail::cut(first, last, thread_count() * detail::kSlack));
+  detail::pool::instance().run(its.size() - 1, [&](std::size_t i) {
+    detail::each_piece(its[i], its[i + 1], [&f](auto b, auto e) { std::for_each(b, e, f); });
+  });
+}
+
+template <class It, class Out, class Op>
+Out transform(It first, It last, Out out, Op op) {
+  std::vector<std::size_t> at = detail::cut(first, last, thread_count() * detail::kSlack);
+  std::vector<It> its = detail::bounds(first, at);
+  std::vector<Out> outs = detail::bounds(out, at);
+  detail::pool::instance().run(its.size() - 1, [&](std::size_t i) {
+    Out o = outs[i];
+    detail::each_piece(its[i], its[i + 1], [&](auto b, auto e) { o = std::transform(b, e, o, op); });
+  });
+  return outs.back();
+}
+
+// op must be associative; the elements are combined in order, starting from init
+template <class It, class V, class Op>
+V reduce(It first, It last, V init, Op op) {
+  std::vector<It> its = detail::bounds(first, detail::cut(first, last, thread_count() * detail::kSlack));
+  std::vector<V> partial(its.size() - 1, init);
+  detail::pool::instance().run(its.size() - 1, [&](std::size_t i) {
+    It b = its[i];
+    V acc = *b;
+    detail::each_piece(++b, its[i + 1], [&](auto p, auto q) { acc = std::accumulate(p, q, std::move(acc), op); });
+    partial[i] = std::move(acc);
+  });
+  for (V &v : partial) init = op(std::move(init), std::move(v));
+  return init;
+}
+
+template <class It, class V>
+V reduce(It first, It last, V init) {
+  return parallel::reduce(first, last, std::move(init), std::plus<>());
+}
+
+/**
+ * sorts [first, last). The range is moved into a contiguous buffer (even
+ * with one thread this beats std::sort through deque iterators), its
+ * pieces are sorted in parallel, and sorted runs are merged pairwise
+ * (the merges of one round in parallel), the last round straight back
+ * into the range. Needs up to 2n default-constructible scratch elements.
+ * Not stable.
+ */
+template <class It, class Comp>
+void sort(It first, It last, Comp comp) {
+  typedef typename std::iterator_traits<It>::value_type value_type;
+  std::size_t threads = thread_count();
+  std::size_t n = last - first;
+  if (n < 4096) {
+    std::sort(first, last, comp);
+    return;
+  }
+  std::vector<std::size_t> at = detail::cut(first, last, threads, std::false_type());
+  std::vector<It> its = detail::bounds(first, at);
+  std::size_t runs = at.size() - 1;
+  std::vector<value_type> buf(n), spare;
+  detail::pool::instance().run(runs, [&](std::size_t i) {
+    value_type *o = buf.data() + at[i];
+    detail::each_piece(its[i], its[i + 1], [&o](auto b, auto e) { o = std::move(b, e, o); });
+    std::sort(buf.data() + at[i], buf.data() + at[i + 1], comp);
+  });
+  if (runs == 1) std::move(buf.begin(), buf.end(), first);
+  if (runs > 2) spare.resize(n);
+  value_type *src = buf.data(), *dst = spare.data();
+  for (std::size_t width = 1; width < runs; width *= 2) {
+    std::size_t pairs = (runs + 2 * width - 1) / (2 * width);
+    bool last_round = width * 2 >= runs;
+    detail::pool::instance().run(pairs, [&](std::size_t p) {
+      std::size_t lo = at[p * 2 * width];
+      std::size_t mid = at[std::min(runs, p * 2 * width + width)];
+      std::size_t hi = at[std::min(runs, p * 2 * width + 2 * width)];
+      std::move_iterator<value_type *> a(src + lo), m(src + mid), b(src + hi);
+      if (last_round) std::merge(a, m, m, b, its[p * 2 * width], comp);
+      else std::merge(a, m, m, b, dst + lo, comp);
+    });
+    std::swap(src, dst);
+  }
+}
+
+template <class It>
+void sort(It first, It last) {
+  parallel::sort(first, last, std::less<>());
+}
+
+// whole-container forms
+template <class C, class F>
+void for_each(C &c, F f) { parallel::for_each(c.begin(), c.end(), std::move(f)); }
+template <class C>
+void sort(C &c) { parallel::sort(c.begin(), c.end()); }
+
+} // namespace parallel
+} // namespace sjtu
+
+#endif
@@ -1,4 +1,4 @@
-#include <memory>  // 使用智能指针
+#include <utility>  // std::forward
 #include <cstddef>  // 使用标准类型大小
 #include <iterator>  // 迭代器操作
 
@@ -8,34 +8,77 @@ template <typename T>
 class double_list {
 private:
     struct Node {
-        std::shared_ptr<T> data;  // 使用 shared_ptr 管理内存
+        T data;  // 元素直接存放在结点内
         Node* pre;
         Node* nxt;
-        Node(const T& val)
-            : data(std::make_shared<T>(val)), pre(nullptr), nxt(nullptr) {}
+        template <class... Args>
+        explicit Node(Args&&... args)  // 原地构造元素
+            : data(std::forward<Args>(args)...), pre(nullptr), nxt(nullptr) {}
     };
 
     Node* head;
     Node* tail;
     std::size_t size_;  // 跟踪列表大小
 
+    // 把链 [first, last] 接到 pos 之前 (pos 为空则接到尾部)
+    void link_before(Node* pos, Node* first, Node* last) {
+        Node* prev = pos ? pos->pre : tail;
+        first->pre = prev;
+        last->nxt = pos;
+        if (prev) prev->nxt = first; else head = first;
+        if (pos) pos->pre = last; else tail = last;
+    }
+
+    // 把链 [first, last] 从本列表摘下, 不释放结点
+    void unlink(Node* first, Node* last) {
+        if (first->pre) first->pre->nxt = last->nxt; else head = last->nxt;
+        if (last->nxt) last->nxt->pre = first->pre; else tail = first->pre;
+        first->pre = last->nxt = nullptr;
+    }
+
 public:
     double_list() : head(nullptr), tail(nullptr), size_(0) {}
 
-    double_list(const double_list<T>& other) {
+    double_list(const double_list<T>& other) : size_(0) {
         head = tail = nullptr;  // 初始化
         Node* current = other.head;  // 从另一个列表复制
         while (current) {
-            insert_tail(*current->data);  // 插入尾部
+            insert_tail(current->data);  // 插入尾部
             current = current->nxt;
         }
         size_ = other.size_;  // 更新大小
     }
 
+    double_list(double_list&& other) noexcept : head(nullptr), tail(nullptr), size_(0) {
+        swap(other);  // 直接接管结点
+    }
+
     ~double_list() {
         clear();  // 清理所有节点
     }
 
+    double_list& operator=(const double_list& other) {
+        if (this == &other) return *this;
+        clear();
+        for (Node* current = other.head; current; current = current->nxt) {
+            insert_tail(current->data);
+        }
+        return *this;
+    }
+
+    double_list& operator=(double_list&& other) noexcept {
+        if (this == &other) return *this;
+        clear();
+        swap(other);
+        return *this;
+    }
+
+    void swap(double_list& other) noexcept {
+        std::swap(head, other.head);
+        std::swap(tail, other.tail);
+        std::swap(size_, other.size_);
+    }
+
     class iterator {
     public:
         using difference_type = std::ptrdiff_t;  // 添加 difference_type
@@ -90,11 +133,11 @@ public:
             if (!current) {
                 throw std::out_of_range("Iterator out of range");
             }
-            return *current->data;  // 返回数据
+            return current->data;  // 返回数据
         }
 
         T* operator->() const noexcept {  // 指针访问
-            return current ? current->data.get() : nullptr;  // 返回指向数据的指针
+            return current ? &current->data : nullptr;  // 返回指向数据的指针
         }
 
         bool operator==(const iterator& rhs) const {  // 检查相等
@@ -141,9 +184,10 @@ public:
         return iterator(node);  // 返回下一个迭代器
     }
 
-    iterator insert(iterator pos, const T& value) {
+    template <class... Args>
+    iterator emplace(iterator pos, Args&&... args) {
         if(pos == end()) {
-            insert_tail(value);
+            emplace_tail(std::forward<Args>(args)...);
             return iterator(tail);
         }
 
@@ -151,7 +195,7 @@ public:
             throw std::out_of_range("Invalid iterator");
         }
 
-        Node* new_node = new Node(value);  // 创建新节点
+        Node* new_node = new Node(std::forward<Args>(args)...);  // 创建新节点
         Node* current = pos.current;
 
         if (current->pre) {  // 如果不是在头部
@@ -168,8 +212,17 @@ public:
         return iterator(new_node);  // 返回新迭代器
     }
 
-    void insert_head(const T& value) {
-        Node* new_node = new Node(value);  // 创建新节点
+    iterator insert(iterator pos, const T& value) {
+        return emplace(pos, value);
+    }
+
+    iterator insert(iterator pos, T&& value) {
+        return emplace(pos, std::move(value));
+    }
+
+    template <class... Args>
+    void emplace_head(Args&&... args) {
+        Node* new_node = new Node(std::forward<Args>(args)...);  // 创建新节点
         if (!head) {  // 如果是空列表
             head = tail = new_node;
         } else {
@@ -180,8 +233,9 @@ public:
         size_++;  // 更新大小
     }
 
-    void insert_tail(const T& value) {
-        Node* new_node = new Node(value);  // 创建新节点
+    template <class... Args>
+    void emplace_tail(Args&&... args) {
+        Node* new_node = new Node(std::forward<Args>(args)...);  // 创建新节点
         if (!tail) {  // 如果是空列表
             head = tail = new_node;
         } else {
@@ -192,6 +246,40 @@ public:
         size_++;  // 更新大小
     }
 
+    void insert_head(const T& value) { emplace_head(value); }
+    void insert_head(T&& value) { emplace_head(std::move(value)); }
+    void insert_tail(const T& value) { emplace_tail(value); }
+    void insert_tail(T&& value) { emplace_tail(std::move(value)); }
+
+    // 把 other 的全部结点接到 pos 之前, O(1), 不复制元素
+    void splice(iterator pos, double_list& other) {
+        if (&other == this || other.empty()) return;
+        link_before(pos.current, other.head, other.tail);
+        size_ += other.size_;
+        other.head = other.tail = nullptr;
+        other.size_ = 0;
+    }
+
+    void splice(iterator pos, double_list& other, iterator it) {
+        if (!it.current) throw std::out_of_range("Invalid iterator");
+        splice(pos, other, it, iterator(it.current->nxt), 1);
+    }
+
+    // 把 other 中 [first, last) 共 n 个结点接到 pos 之前; n 由调用者给出, 所以是 O(1)
+    // 同一链表内 pos 不能落在 (first, last) 中; pos == first 时什么也不做
+    void splice(iterator pos, double_list& other, iterator first, iterator last, std::size_t n) {
+        if (first == last || n == 0) return;
+        if (&other == this && (pos == last || pos == first)) return;  // 已经在 pos 之前
+        Node* f = first.current;
+        Node* l = last.current ? last.current->pre : other.tail;
+        other.unlink(f, l);
+        link_before(pos.current, f, l);
+        if (&other != this) {
+            other.size_ -= n;
+            size_ += n;
+        }
+    }
+
     void delete_head() {
         if (!head) {
             return;
@@ -250,28 +338,28 @@ public:
         if (!head) {
             throw std::out_of_range("List is empty");  // 检查是否为空
         }
-        return *head->data;  // 返回第一个元素
+        return head->data;  // 返回第一个元素
     }
 
     const T& front() const {
         if (!head) {
             throw std::out_of_range("List is empty");  // 检查是否为空
         }
-        return *head->data;  // 返回第一个元素
+        return head->data;  // 返回第一个元素
     }
 
     T& back() {
         if (!tail) {
             throw std::out_of_range("List is empty");  // 检查是否为空
         }
-        return *tail->data;  // 返回最后一个元素
+        return tail->data;  // 返回最后一个元素
     }
 
     const T& back() const {
         if (!tail) {
             throw std::out_of_range("List is empty");  // 检查是否为空
         }
-        return *tail->data;  // 返回最后一个元素
+        return tail->data;  // 返回最后一个元素
     }
 };
 
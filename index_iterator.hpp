@@ -0,0 +1,105 @@
+#ifndef SJTU_INDEX_ITERATOR_HPP
+#define SJTU_INDEX_ITERATOR_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+namespace sjtu {
+
+/**
+ * Random access iterator over a container that is addressed by index:
+ * an owner and a position, dereferenced through owner->Element(index).
+ * Used by bounded_deque and mapped_deque, whose elements sit in a
+ * single ring or in mapped pages, so the position is all there is to
+ * keep. Container declares index_iterator a friend and provides
+ * size() and Element(size_t) (const, returning T *); only Container
+ * builds iterators that refer to it.
+ *
+ * With Checked, dereferencing the end (or a default-constructed
+ * iterator) throws std::out_of_range. Subtracting iterators of
+ * different containers always does.
+ */
+template <class Container, class T, bool Const, bool Checked>
+class index_iterator {
+  friend Container;
+  template <class, class, bool, bool> friend class index_iterator;
+  typedef typename std::conditional<Const, const Container, Container>::type owner_type;
+
+  owner_type *owner = nullptr;
+  std::size_t index = 0;
+
+  index_iterator(owner_type *o, std::size_t i) : owner(o), index(i) {}
+
+public:
+  typedef std::random_access_iterator_tag iterator_category;
+  typedef T value_type;
+  typedef std::ptrdiff_t difference_type;
+  typedef typename std::conditional<Const, const T *, T *>::type pointer;
+  typedef typename std::conditional<Const, const T &, T &>::type reference;
+
+  index_iterator() = default;
+  template <bool C, class = typename std::enable_if<Const && !C>::type>
+  index_iterator(const index_iterator<Container, T, C, Checked> &other) : owner(other.owner), index(other.index) {}
+
+  reference operator*() const {
+    if (Checked && (owner == nullptr || index >= owner->size())) throw std::out_of_range("");
+    return *owner->Element(index);
+  }
+  pointer operator->() const { return &**this; }
+  reference operator[](difference_type n) const { return *(*this + n); }
+
+  index_iterator &operator+=(difference_type n) {
+    index += n;
+    return *this;
+  }
+  index_iterator &operator-=(difference_type n) { return *this += -n; }
+  index_iterator &operator++() { return *this += 1; }
+  index_iterator &operator--() { return *this += -1; }
+  index_iterator operator++(int) {
+    index_iterator old = *this;
+    *this += 1;
+    return old;
+  }
+  index_iterator operator--(int) {
+    index_iterator old = *this;
+    *this += -1;
+    return old;
+  }
+  index_iterator operator+(difference_type n) const {
+    index_iterator temp = *this;
+    return temp += n;
+  }
+  index_iterator operator-(difference_type n) const {
+    index_iterator temp = *this;
+    return temp += -n;
+  }
+  friend index_iterator operator+(difference_type n, const index_iterator &i) { return i + n; }
+
+  // throws if the iterators belong to different containers
+  template <bool C>
+  difference_type operator-(const index_iterator<Container, T, C, Checked> &rhs) const {
+    if (owner != rhs.owner || owner == nullptr) throw std::out_of_range("");
+    return static_cast<difference_type>(index) - static_cast<difference_type>(rhs.index);
+  }
+
+  template <bool C>
+  bool operator==(const index_iterator<Container, T, C, Checked> &rhs) const {
+    return owner == rhs.owner && index == rhs.index;
+  }
+  template <bool C>
+  bool operator!=(const index_iterator<Container, T, C, Checked> &rhs) const { return !(*this == rhs); }
+  template <bool C>
+  bool operator<(const index_iterator<Container, T, C, Checked> &rhs) const { return *this - rhs < 0; }
+  template <bool C>
+  bool operator>(const index_iterator<Container, T, C, Checked> &rhs) const { return rhs < *this; }
+  template <bool C>
+  bool operator<=(const index_iterator<Container, T, C, Checked> &rhs) const { return !(rhs < *this); }
+  template <bool C>
+  bool operator>=(const index_iterator<Container, T, C, Checked> &rhs) const { return !(*this < rhs); }
+};
+
+} // namespace sjtu
+
+#endif
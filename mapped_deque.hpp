@@ -0,0 +1,371 @@
+#ifndef SJTU_MAPPED_DEQUE_HPP
+#define SJTU_MAPPED_DEQUE_HPP
+
+#include "index_iterator.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace sjtu {
+
+/**
+ * A deque of trivially copyable T kept in a memory-mapped file, for
+ * append-mostly logs that outgrow RAM: push_back at the end, pop_front
+ * (and pop_back), random access anywhere.
+ *
+ * The file is an array of PageBytes pages. Page 0 is the header; every
+ * other page is a block of PageBytes / sizeof(T) elements, a free page,
+ * or part of the directory. The directory is a contiguous run of pages
+ * holding a ring of block page numbers (the i-th live block first) and a
+ * stack of free page numbers. All of the state is in the mapping, so
+ * opening an existing file is an mmap and a check of the header and the
+ * directory against the file, and at() works straight away.
+ *
+ * A block that pop_front (or pop_back) empties is recycled: its page
+ * goes on the free stack, and where the file system supports it the
+ * page is punched out of the file (fallocate PUNCH_HOLE), so a log that
+ * keeps a bounded window holds a bounded amount of disk. New blocks take
+ * free pages first. The file grows geometrically and the directory
+ * doubles when it fills.
+ *
+ * flush() msyncs the mapping; without it the kernel writes pages back in
+ * its own time. A crash between flushes can lose or tear the latest
+ * changes. One process at a time may open a file. Growing the file
+ * remaps it, so a push_back may invalidate references; iterators are
+ * indices and stay valid.
+ */
+template <class T, size_t PageBytes = 65536>
+class mapped_deque {
+  static_assert(std::is_trivially_copyable<T>::value, "mapped_deque stores T as raw bytes");
+  static const size_t kCap = PageBytes / sizeof(T);  // elements per block
+  static_assert(kCap != 0, "a page must hold at least one element");
+  static_assert(PageBytes % 4096 == 0, "PageBytes must be a multiple of the OS page size");
+
+  typedef std::uint64_t u64;
+
+  struct Header {
+    char magic[8];
+    u64 elem_size, page_bytes;
+    u64 first;               // virtual index of the front element; element i is first + i
+    u64 size;
+    u64 blocks;              // live blocks, the one holding first being block 0
+    u64 dir_page, dir_cap;   // directory run: dir_cap ring slots, then dir_cap free slots
+    u64 dir_head;            // ring slot of block 0
+    u64 free_count;
+    u64 pages;               // pages handed out, the header included
+  };
+  static_assert(sizeof(Header) <= PageBytes, "the header must fit in page 0");
+
+  static const char *Magic() { return "SJTUMDQ1"; }
+
+  int fd = -1;
+  char *base = nullptr;  // the mapping
+  size_t mapped = 0;     // pages in the file and the mapping
+
+  Header &H() const { return *reinterpret_cast<Header *>(base); }
+  u64 *Ring() const { return reinterpret_cast<u64 *>(base + H().dir_page * PageBytes); }
+  u64 *Free() const { return Ring() + H().dir_cap; }
+  char *Page(u64 p) const { return base + p * PageBytes; }
+
+  [[noreturn]] static void Fail(const char *what) {
+    throw std::system_error(errno, std::generic_category(), std::string("mapped_deque: ") + what);
+  }
+
+  void Map(size_t pages) {
+    void *p = ::mmap(nullptr, pages * PageBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) Fail("mmap");
+    base = static_cast<char *>(p);
+    mapped = pages;
+  }
+
+  void Unmap() {
+    if (base) ::munmap(base, mapped * PageBytes);
+    base = nullptr;
+    mapped = 0;
+  }
+
+  // make the file (and the mapping) at least pages long, growing it geometrically
+  void Reserve(size_t pages) {
+    if (pages <= mapped) return;
+    if (pages < mapped * 2) pages = mapped * 2;
+    if (::ftruncate(fd, off_t(pages * PageBytes)) != 0) Fail("ftruncate");
+    Unmap();
+    Map(pages);
+  }
+
+  // give a page's disk space back; the page reads as zeros afterwards
+  void Punch(u64 p, u64 n) {
+#if defined(FALLOC_FL_PUNCH_HOLE) && defined(FALLOC_FL_KEEP_SIZE)
+    (void)::fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, off_t(p * PageBytes), off_t(n * PageBytes));
+#else
+    (void)p, (void)n;
+#endif
+  }
+
+  // a run of n pages past the last one handed out
+  u64 Grow(u64 n) {
+    Reserve(H().pages + n);
+    u64 p = H().pages;
+    H().pages += n;
+    return p;
+  }
+
+  /**
+   * a directory of at least need slots: a new run at the end of the file,
+   * the ring unwrapped to start at slot 0. The old run's pages are freed
+   * into the new one, so need must leave room for them.
+   */
+  void GrowDir(u64 need) {
+    Header h = H();
+    u64 old_pages = DirPages(h.dir_cap);
+    u64 cap = h.dir_cap ? h.dir_cap * 2 : PageBytes / (2 * sizeof(u64));
+    while (cap < need + old_pages) cap *= 2;
+    u64 pages = DirPages(cap);
+    u64 p = Grow(pages);  // may remap: read the old run only after this
+    u64 *ring = reinterpret_cast<u64 *>(Page(p)), *free = ring + cap;
+    if (h.dir_cap) {
+      const u64 *old = reinterpret_cast<const u64 *>(Page(h.dir_page));
+      for (u64 i = 0; i < h.blocks; ++i) ring[i] = old[(h.dir_head + i) % h.dir_cap];
+      std::memcpy(free, old + h.dir_cap, h.free_count * sizeof(u64));
+      Punch(h.dir_page, old_pages);
+      for (u64 i = 0; i < old_pages; ++i) free[h.free_count++] = h.dir_page + i;
+    }
+    H().dir_page = p;
+    H().dir_cap = cap;
+    H().dir_head = 0;
+    H().free_count = h.free_count;
+  }
+
+  // a page for a new block, from the free stack if it has one
+  u64 NewPage() {
+    if (H().free_count) return Free()[--H().free_count];
+    if (H().blocks + H().free_count + 1 > H().dir_cap) {
+      GrowDir(H().blocks + H().free_count + 1);
+      if (H().free_count) return Free()[--H().free_count];
+    }
+    return Grow(1);
+  }
+
+  void FreePage(u64 p) {
+    Punch(p, 1);
+    Free()[H().free_count++] = p;
+  }
+
+  // blocks that [first, first + size) spans
+  static u64 Needed(u64 first, u64 size) { return (first + size + kCap - 1) / kCap - first / kCap; }
+
+  // pages the directory run of dir_cap ring slots (and as many free slots) takes
+  static u64 DirPages(u64 dir_cap) { return (dir_cap * 2 * sizeof(u64) + PageBytes - 1) / PageBytes; }
+
+  /**
+   * whether the header of a freshly mapped file describes a deque that
+   * fits in it: the directory run inside the file, the counts in step,
+   * and every block and free page number pointing at a page of the file
+   * outside the header and the directory. Reads nothing it has not
+   * bounded first.
+   */
+  bool Check() const {
+    const Header &h = H();
+    if (std::memcmp(h.magic, Magic(), sizeof(h.magic)) != 0 || h.elem_size != sizeof(T) ||
+        h.page_bytes != PageBytes)
+      return false;
+    if (h.pages == 0 || h.pages > mapped) return false;
+    if (h.dir_cap == 0 || h.dir_cap > h.pages * PageBytes / (2 * sizeof(u64))) return false;
+    u64 dir_pages = DirPages(h.dir_cap);
+    if (h.dir_page == 0 || h.dir_page > h.pages || dir_pages > h.pages - h.dir_page) return false;
+    if (h.dir_head >= h.dir_cap || h.blocks > h.dir_cap || h.free_count > h.dir_cap) return false;
+    if (h.size > h.blocks * kCap || h.first > ~u64(0) - h.size - kCap) return false;
+    if (Needed(h.first, h.size) != h.blocks) return false;
+    auto fits = [&](u64 p) { return p != 0 && p < h.pages && (p < h.dir_page || p - h.dir_page >= dir_pages); };
+    for (u64 i = 0; i < h.blocks; ++i)
+      if (!fits(Ring()[(h.dir_head + i) % h.dir_cap])) return false;
+    for (u64 i = 0; i < h.free_count; ++i)
+      if (!fits(Free()[i])) return false;
+    return true;
+  }
+
+  T *Element(u64 i) const {
+    const Header &h = H();
+    u64 v = h.first + i;
+    u64 b = v / kCap - h.first / kCap;
+    u64 page = Ring()[(h.dir_head + b) % h.dir_cap];
+    return reinterpret_cast<T *>(Page(page)) + v % kCap;
+  }
+
+  template <class, class, bool, bool> friend class index_iterator;
+
+public:
+  typedef index_iterator<mapped_deque, T, false, true> iterator;
+  typedef index_iterator<mapped_deque, T, true, true> const_iterator;
+
+  /**
+   * opens the deque in the file at path, creating an empty one if the
+   * file does not exist or is empty. throws std::system_error if the
+   * file cannot be opened or mapped, and std::runtime_error if it holds
+   * something else (or a deque of another element size or PageBytes),
+   * or a header or directory that does not fit the file, e.g. after it
+   * was truncated.
+   */
+  explicit mapped_deque(const std::string &path) {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) Fail("open");
+    try {
+      struct stat st;
+      if (::fstat(fd, &st) != 0) Fail("fstat");
+      if (st.st_size == 0) {
+        if (::ftruncate(fd, off_t(PageBytes)) != 0) Fail("ftruncate");
+        Map(1);
+        Header h = Header();
+        std::memcpy(h.magic, Magic(), sizeof(h.magic));
+        h.elem_size = sizeof(T);
+        h.page_bytes = PageBytes;
+        h.pages = 1;
+        H() = h;
+        GrowDir(0);
+        return;
+      }
+      if (st.st_size % PageBytes != 0) throw std::runtime_error("mapped_deque: not a deque file");
+      Map(size_t(st.st_size / PageBytes));
+      if (!Check()) throw std::runtime_error("mapped_deque: not a deque file of this T / PageBytes");
+    } catch (...) {
+      Unmap();
+      ::close(fd);
+      throw;
+    }
+  }
+
+  mapped_deque(const mapped_deque &) = delete;
+  mapped_deque &operator=(const mapped_deque &) = delete;
+
+  // takes other's file; other is left empty without one (see file_pages())
+  mapped_deque(mapped_deque &&other) noexcept { swap(other); }
+  mapped_deque &operator=(mapped_deque &&other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  // unmaps and closes; the kernel still writes the dirty pages back
+  ~mapped_deque() {
+    Unmap();
+    if (fd >= 0) ::close(fd);
+  }
+
+  void swap(mapped_deque &other) noexcept {
+    std::swap(fd, other.fd);
+    std::swap(base, other.base);
+    std::swap(mapped, other.mapped);
+  }
+
+  // writes the mapping back to the file and waits for it
+  void flush() {
+    if (!base) return;
+    if (::msync(base, mapped * PageBytes, MS_SYNC) != 0) Fail("msync");
+  }
+
+  // a moved-from deque has no file: it is empty, and push_back throws std::out_of_range
+  bool empty() const { return size() == 0; }
+  size_t size() const { return base ? size_t(H().size) : 0; }
+
+  // pages in the file (the header, the directory and free pages included); 0 without a file
+  size_t file_pages() const { return base ? size_t(H().pages) : 0; }
+  // pages on the free stack, waiting to be reused
+  size_t free_pages() const { return base ? size_t(H().free_count) : 0; }
+
+  /**
+   * access specified element with bounds checking
+   * throw index_out_of_bound if out of bound.
+   */
+  T &at(const size_t &pos) {
+    if (pos >= size()) throw std::out_of_range("");
+    return *Element(pos);
+  }
+  const T &at(const size_t &pos) const {
+    if (pos >= size()) throw std::out_of_range("");
+    return *Element(pos);
+  }
+  T &operator[](const size_t &pos) { return at(pos); }
+  const T &operator[](const size_t &pos) const { return at(pos); }
+
+  // throw when the container is empty
+  T &front() { return at(0); }
+  const T &front() const { return at(0); }
+  T &back() {
+    if (empty()) throw std::out_of_range("");
+    return at(size() - 1);
+  }
+  const T &back() const {
+    if (empty()) throw std::out_of_range("");
+    return at(size() - 1);
+  }
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, size()); }
+  const_iterator cbegin() const { return const_iterator(this, 0); }
+  const_iterator cend() const { return const_iterator(this, size()); }
+
+  void push_back(const T &value) {
+    if (!base) throw std::out_of_range("");
+    T copy = value;  // value may live in a page that a remap moves
+    if (Needed(H().first, H().size + 1) > H().blocks) {
+      u64 p = NewPage();
+      Ring()[(H().dir_head + H().blocks) % H().dir_cap] = p;
+      ++H().blocks;
+    }
+    std::memcpy(static_cast<void *>(Element(H().size)), &copy, sizeof(T));
+    ++H().size;
+  }
+
+  // throw when the container is empty
+  void pop_front() {
+    if (empty()) throw std::out_of_range("");
+    Header &h = H();
+    ++h.first;
+    --h.size;
+    if (Needed(h.first, h.size) < h.blocks) {  // the front block is used up
+      FreePage(Ring()[h.dir_head]);
+      h.dir_head = (h.dir_head + 1) % h.dir_cap;
+      --h.blocks;
+    }
+  }
+
+  void pop_back() {
+    if (empty()) throw std::out_of_range("");
+    Header &h = H();
+    --h.size;
+    if (Needed(h.first, h.size) < h.blocks) {
+      --h.blocks;
+      FreePage(Ring()[(h.dir_head + h.blocks) % h.dir_cap]);
+    }
+  }
+
+  // frees every block; the file keeps its size, the pages go on the free stack
+  void clear() {
+    if (!base) return;
+    Header &h = H();
+    while (h.blocks) {
+      --h.blocks;
+      FreePage(Ring()[(h.dir_head + h.blocks) % h.dir_cap]);
+    }
+    h.first = h.size = h.dir_head = 0;
+  }
+};
+
+template <class T, size_t PageBytes>
+const size_t mapped_deque<T, PageBytes>::kCap;
+
+} // namespace sjtu
+
+#endif
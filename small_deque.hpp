@@ -0,0 +1,479 @@
+#ifndef SJTU_SMALL_DEQUE_HPP
+#define SJTU_SMALL_DEQUE_HPP
+
+#include "deque.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace sjtu {
+
+/**
+ * A deque that keeps up to N elements inside the object, as a ring of N
+ * slots, and allocates nothing until it holds more. The push that would
+ * make it N + 1 spills it: the elements move into a heap-allocated
+ * deque<T, Alloc, Policy>, which serves every call from then on. It goes
+ * back to the inline ring when it is emptied (by pops, erases or
+ * clear()), or on shrink_to_fit() once size() <= N.
+ *
+ * sizeof(small_deque<T, N>) is N * sizeof(T) plus three words (and any
+ * alignment padding), whatever the state. Moving an inline small_deque
+ * moves its elements (one memcpy of the ring when T is trivially
+ * copyable); moving a spilled one moves a pointer.
+ *
+ * Iterators work for both states. A spill, and the move back inline,
+ * invalidates all of them; otherwise they follow the rules of the state
+ * the small_deque is in (inline ones are indices, so an insert or erase
+ * invalidates those past the position).
+ */
+template <class T, size_t N = 16, class Alloc = std::allocator<T>, class Policy = pow2_balance>
+class small_deque {
+public:
+  typedef deque<T, Alloc, Policy> heap_type;
+  static const size_t inline_capacity = N;
+
+private:
+  static_assert(N > 0, "small_deque needs at least one inline slot");
+
+  typedef typename std::allocator_traits<Alloc>::template rebind_alloc<heap_type> heap_alloc;
+  typedef std::allocator_traits<heap_alloc> heap_traits;
+
+  alignas(T) unsigned char store[N * sizeof(T)];
+  size_t head = 0;   // slot of the first inline element
+  size_t count = 0;  // inline elements
+  heap_type *heap = nullptr;  // the elements once spilled, null while inline
+
+  T *Slot(size_t i) {
+    i += head;
+    return reinterpret_cast<T *>(store) + (i < N ? i : i - N);
+  }
+  const T *Slot(size_t i) const {
+    i += head;
+    return reinterpret_cast<const T *>(store) + (i < N ? i : i - N);
+  }
+
+  void DestroyInline() {
+    if (!std::is_trivially_destructible<T>::value)
+      for (size_t i = 0; i < count; ++i) Slot(i)->~T();
+    head = count = 0;
+  }
+
+  // move the inline elements into a new heap deque; untouched if that throws
+  void Spill() {
+    heap_alloc a;
+    heap_type *h = heap_traits::allocate(a, 1);
+    ::new (static_cast<void *>(h)) heap_type();
+    try {
+      for (size_t i = 0; i < count; ++i) h->push_back(std::move_if_noexcept(*Slot(i)));
+    } catch (...) {
+      h->~heap_type();
+      heap_traits::deallocate(a, h, 1);
+      throw;
+    }
+    DestroyInline();
+    heap = h;
+  }
+
+  void Release() {
+    heap_alloc a;
+    heap->~heap_type();
+    heap_traits::deallocate(a, heap, 1);
+    heap = nullptr;
+  }
+
+  // *this is empty and inline; take other's elements and leave it empty
+  void MoveFrom(small_deque &other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+    if (other.heap) {
+      heap = other.heap;
+      other.heap = nullptr;
+      return;
+    }
+    if (std::is_trivially_copyable<T>::value) {
+      std::memcpy(store, other.store, sizeof(store));
+      head = other.head;
+      count = other.count;
+      other.head = other.count = 0;
+      return;
+    }
+    for (; count < other.count; ++count) ::new (static_cast<void *>(Slot(count))) T(std::move(*other.Slot(count)));
+    other.DestroyInline();
+  }
+
+  void CopyFrom(const small_deque &other) {
+    if (other.heap) {
+      heap_alloc a;
+      heap_type *h = heap_traits::allocate(a, 1);
+      try {
+        ::new (static_cast<void *>(h)) heap_type(*other.heap);
+      } catch (...) {
+        heap_traits::deallocate(a, h, 1);
+        throw;
+      }
+      heap = h;
+      return;
+    }
+    if (std::is_trivially_copyable<T>::value) {
+      std::memcpy(store, other.store, sizeof(store));
+      head = other.head;
+      count = other.count;
+      return;
+    }
+    try {
+      for (; count < other.count; ++count) ::new (static_cast<void *>(Slot(count))) T(*other.Slot(count));
+    } catch (...) {
+      DestroyInline();
+      throw;
+    }
+  }
+
+  template <bool Const>
+  class basic_iterator {
+    friend class small_deque;
+    typedef typename std::conditional<Const, const small_deque, small_deque>::type owner_type;
+    typedef typename std::conditional<Const, typename heap_type::const_iterator,
+                                      typename heap_type::iterator>::type heap_iterator;
+
+    owner_type *owner = nullptr;
+    size_t index = 0;  // the position while the owner is inline
+    heap_iterator it;  // the position while it is spilled
+
+    basic_iterator(owner_type *o, size_t i) : owner(o), index(i) {}
+    basic_iterator(owner_type *o, heap_iterator h) : owner(o), it(h) {}
+
+    bool Spilled() const { return owner != nullptr && owner->heap != nullptr; }
+
+  public:
+    typedef std::random_access_iterator_tag iterator_category;
+    typedef T value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef typename std::conditional<Const, const T *, T *>::type pointer;
+    typedef typename std::conditional<Const, const T &, T &>::type reference;
+
+    basic_iterator() = default;
+    template <bool C, class = typename std::enable_if<Const && !C>::type>
+    basic_iterator(const basic_iterator<C> &other) : owner(other.owner), index(other.index), it(other.it) {}
+
+    reference operator*() const {
+      if (Spilled()) return *it;
+      if (owner == nullptr || index >= owner->count) throw std::out_of_range("");
+      return *owner->Slot(index);
+    }
+    pointer operator->() const { return &**this; }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    basic_iterator &operator+=(difference_type n) {
+      if (Spilled()) it += n;
+      else index += n;
+      return *this;
+    }
+    basic_iterator &operator-=(difference_type n) { return *this += -n; }
+    basic_iterator &operator++() { return *this += 1; }
+    basic_iterator &operator--() { return *this += -1; }
+    basic_iterator operator++(int) {
+      basic_iterator old = *this;
+      *this += 1;
+      return old;
+    }
+    basic_iterator operator--(int) {
+      basic_iterator old = *this;
+      *this += -1;
+      return old;
+    }
+    basic_iterator operator+(difference_type n) const {
+      basic_iterator temp = *this;
+      return temp += n;
+    }
+    basic_iterator operator-(difference_type n) const {
+      basic_iterator temp = *this;
+      return temp += -n;
+    }
+    friend basic_iterator operator+(difference_type n, const basic_iterator &i) { return i + n; }
+
+    // throws if the iterators belong to different containers
+    template <bool C>
+    difference_type operator-(const basic_iterator<C> &rhs) const {
+      if (owner != rhs.owner || owner == nullptr) throw std::out_of_range("");
+      if (Spilled()) return it - rhs.it;
+      return static_cast<difference_type>(index) - static_cast<difference_type>(rhs.index);
+    }
+
+    template <bool C>
+    bool operator==(const basic_iterator<C> &rhs) const {
+      return owner == rhs.owner && (Spilled() ? it == rhs.it : index == rhs.index);
+    }
+    template <bool C>
+    bool operator!=(const basic_iterator<C> &rhs) const { return !(*this == rhs); }
+    template <bool C>
+    bool operator<(const basic_iterator<C> &rhs) const { return *this - rhs < 0; }
+    template <bool C>
+    bool operator>(const basic_iterator<C> &rhs) const { return rhs < *this; }
+    template <bool C>
+    bool operator<=(const basic_iterator<C> &rhs) const { return !(rhs < *this); }
+    template <bool C>
+    bool operator>=(const basic_iterator<C> &rhs) const { return !(*this < rhs); }
+
+    template <bool> friend class basic_iterator;
+  };
+
+public:
+  typedef basic_iterator<false> iterator;
+  typedef basic_iterator<true> const_iterator;
+
+  small_deque() {}
+  small_deque(const small_deque &other) { CopyFrom(other); }
+  small_deque(small_deque &&other) noexcept(std::is_nothrow_move_constructible<T>::value) { MoveFrom(other); }
+
+  template <class InputIt, class = typename std::enable_if<!std::is_integral<InputIt>::value>::type>
+  small_deque(InputIt first, InputIt last) {
+    try {
+      for (; first != last; ++first) emplace_back(*first);
+    } catch (...) {
+      clear();
+      throw;
+    }
+  }
+
+  small_deque(size_t n, const T &value) {
+    try {
+      for (size_t i = 0; i < n; ++i) push_back(value);
+    } catch (...) {
+      clear();
+      throw;
+    }
+  }
+
+  ~small_deque() { clear(); }
+
+  small_deque &operator=(const small_deque &other) {
+    if (this == &other) return *this;
+    small_deque copy(other);  // if an element copy throws, *this is untouched
+    clear();
+    MoveFrom(copy);
+    return *this;
+  }
+
+  small_deque &operator=(small_deque &&other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+    if (this == &other) return *this;
+    clear();
+    MoveFrom(other);
+    return *this;
+  }
+
+  void swap(small_deque &other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+    if (heap && other.heap) {
+      std::swap(heap, other.heap);
+      return;
+    }
+    small_deque temp(std::move(other));
+    other.MoveFrom(*this);
+    MoveFrom(temp);
+  }
+
+  // whether the elements live in the heap deque rather than inline
+  bool spilled() const { return heap != nullptr; }
+
+  bool empty() const { return size() == 0; }
+  size_t size() const { return heap ? heap->size() : count; }
+
+  /**
+   * access specified element with bounds checking
+   * throw index_out_of_bound if out of bound.
+   */
+  T &at(const size_t &pos) {
+    if (heap) return heap->at(pos);
+    if (pos >= count) throw std::out_of_range("");
+    return *Slot(pos);
+  }
+  const T &at(const size_t &pos) const {
+    if (heap) return static_cast<const heap_type *>(heap)->at(pos);
+    if (pos >= count) throw std::out_of_range("");
+    return *Slot(pos);
+  }
+  T &operator[](const size_t &pos) { return at(pos); }
+  const T &operator[](const size_t &pos) const { return at(pos); }
+
+  // throw when the container is empty
+  T &front() { return at(0); }
+  const T &front() const { return at(0); }
+  T &back() {
+    if (empty()) throw std::out_of_range("");
+    return at(size() - 1);
+  }
+  const T &back() const {
+    if (empty()) throw std::out_of_range("");
+    return at(size() - 1);
+  }
+
+  iterator begin() { return heap ? iterator(this, heap->begin()) : iterator(this, 0); }
+  iterator end() { return heap ? iterator(this, heap->end()) : iterator(this, count); }
+  const_iterator cbegin() const { return heap ? const_iterator(this, heap->cbegin()) : const_iterator(this, 0); }
+  const_iterator cend() const { return heap ? const_iterator(this, heap->cend()) : const_iterator(this, count); }
+
+  void clear() {
+    if (heap) Release();
+    DestroyInline();
+  }
+
+  // move back inline if the elements fit, else shrink the heap deque
+  void shrink_to_fit() {
+    if (!heap) return;
+    if (heap->size() > N) {
+      heap->shrink_to_fit();
+      return;
+    }
+    try {
+      for (typename heap_type::iterator it = heap->begin(); it != heap->end(); ++it, ++count)
+        ::new (static_cast<void *>(Slot(count))) T(std::move_if_noexcept(*it));
+    } catch (...) {
+      DestroyInline();
+      throw;
+    }
+    Release();
+  }
+
+  /**
+   * insert value before pos.
+   * return an iterator pointing to the inserted value.
+   * throw if the iterator is invalid or it points to a wrong place.
+   */
+  iterator insert(iterator pos, const T &value) { return emplace(pos, value); }
+  iterator insert(iterator pos, T &&value) { return emplace(pos, std::move(value)); }
+
+  template <class... Args>
+  iterator emplace(iterator pos, Args&&... args) {
+    if (pos.owner != this) throw std::out_of_range("");
+    if (heap) return iterator(this, heap->emplace(pos.it, std::forward<Args>(args)...));
+    size_t p = pos.index;
+    if (p > count) throw std::out_of_range("");
+    if (p == count) {
+      emplace_back(std::forward<Args>(args)...);
+      return heap ? iterator(this, heap->end() - 1) : iterator(this, p);
+    }
+    if (p == 0) {
+      emplace_front(std::forward<Args>(args)...);
+      return begin();
+    }
+    T value(std::forward<Args>(args)...);  // args may refer to an element about to move
+    if (count == N) {
+      Spill();
+      return iterator(this, heap->insert(heap->begin() + p, std::move(value)));
+    }
+    if (p < count / 2) {
+      // open a slot in front of the ring and shift [0, p) down into it
+      size_t slot = head ? head - 1 : N - 1;
+      ::new (static_cast<void *>(reinterpret_cast<T *>(store) + slot)) T(std::move(*Slot(0)));
+      head = slot;
+      ++count;
+      for (size_t i = 1; i < p; ++i) *Slot(i) = std::move(*Slot(i + 1));
+    } else {
+      ::new (static_cast<void *>(Slot(count))) T(std::move(*Slot(count - 1)));
+      ++count;
+      for (size_t i = count - 2; i > p; --i) *Slot(i) = std::move(*Slot(i - 1));
+    }
+    *Slot(p) = std::move(value);
+    return iterator(this, p);
+  }
+
+  /**
+   * remove the element at pos.
+   * return an iterator pointing to the following element.
+   * throw if the iterator is invalid or it points to a wrong place.
+   */
+  iterator erase(iterator pos) {
+    if (pos.owner != this) throw std::out_of_range("");
+    if (heap) {
+      typename heap_type::iterator next = heap->erase(pos.it);
+      if (!heap->empty()) return iterator(this, next);
+      Release();
+      return end();
+    }
+    size_t p = pos.index;
+    if (p >= count) throw std::out_of_range("");
+    if (p < count / 2) {
+      for (size_t i = p; i > 0; --i) *Slot(i) = std::move(*Slot(i - 1));
+      Slot(0)->~T();
+      head = head + 1 == N ? 0 : head + 1;
+    } else {
+      for (size_t i = p; i + 1 < count; ++i) *Slot(i) = std::move(*Slot(i + 1));
+      Slot(count - 1)->~T();
+    }
+    --count;
+    return iterator(this, p);
+  }
+
+  void push_back(const T &value) { emplace_back(value); }
+  void push_back(T &&value) { emplace_back(std::move(value)); }
+
+  template <class... Args>
+  void emplace_back(Args&&... args) {
+    if (heap) {
+      heap->emplace_back(std::forward<Args>(args)...);
+      return;
+    }
+    if (count == N) {
+      T value(std::forward<Args>(args)...);
+      Spill();
+      heap->push_back(std::move(value));
+      return;
+    }
+    ::new (static_cast<void *>(Slot(count))) T(std::forward<Args>(args)...);
+    ++count;
+  }
+
+  void push_front(const T &value) { emplace_front(value); }
+  void push_front(T &&value) { emplace_front(std::move(value)); }
+
+  template <class... Args>
+  void emplace_front(Args&&... args) {
+    if (heap) {
+      heap->emplace_front(std::forward<Args>(args)...);
+      return;
+    }
+    if (count == N) {
+      T value(std::forward<Args>(args)...);
+      Spill();
+      heap->push_front(std::move(value));
+      return;
+    }
+    size_t slot = head ? head - 1 : N - 1;
+    ::new (static_cast<void *>(reinterpret_cast<T *>(store) + slot)) T(std::forward<Args>(args)...);
+    head = slot;
+    ++count;
+  }
+
+  // throw when the container is empty
+  void pop_back() {
+    if (heap) {
+      heap->pop_back();
+      if (heap->empty()) Release();
+      return;
+    }
+    if (count == 0) throw std::out_of_range("");
+    Slot(--count)->~T();
+  }
+
+  void pop_front() {
+    if (heap) {
+      heap->pop_front();
+      if (heap->empty()) Release();
+      return;
+    }
+    if (count == 0) throw std::out_of_range("");
+    Slot(0)->~T();
+    head = head + 1 == N ? 0 : head + 1;
+    --count;
+  }
+};
+
+template <class T, size_t N, class Alloc, class Policy>
+const size_t small_deque<T, N, Alloc, Policy>::inline_capacity;
+
+} // namespace sjtu
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef SJTU_SPSC_DEQUE_HPP
+#define SJTU_SPSC_DEQUE_HPP
+
+#include "deque.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace sjtu {
+
+/**
+ * Single-producer / single-consumer deque: one thread calls
+ * try_push_back, another calls try_pop_front, with no locks.
+ *
+ * The storage is the same chain of fixed-capacity ring buffers as a
+ * deque with a fixed_block / fixed_bytes Policy, minus everything the
+ * two ends would have to agree on: blocks never split or merge (there
+ * is no Balance), the producer links a new block when the tail one is
+ * full and the consumer retires a block once it has read past it.
+ * Element i lives in slot i & (capacity - 1) of its block.
+ *
+ * The ends only talk through two counters: tail (elements ever pushed,
+ * written by the producer with release) and head (elements ever popped,
+ * written by the consumer with release). Each side keeps a cached copy
+ * of the other's counter and re-reads it with acquire only when the
+ * cache says full / empty. The two sides' fields sit on separate cache
+ * lines. One retired block is kept as a spare for the producer, so a
+ * steady stream does not allocate.
+ *
+ * Alloc is used from both threads (the producer allocates, the consumer
+ * frees), so it must be safe to share; std::allocator is.
+ */
+template <class T, class Alloc = std::allocator<T>, class Policy = fixed_bytes<>>
+class spsc_deque {
+private:
+  static const size_t kCap = detail::fixed_capacity<Policy, T>::value;
+  static_assert(kCap != 0, "spsc_deque needs a fixed-capacity Policy (fixed_block / fixed_bytes)");
+  static const size_t kLine = 64;  // cache line, to keep the ends apart
+
+  typedef std::allocator_traits<Alloc> traits;
+
+  struct Block {
+    T *data;
+    std::atomic<Block *> next;
+    explicit Block(T *d) : data(d), next(nullptr) {}
+  };
+  typedef typename traits::template rebind_alloc<Block> block_alloc;
+  typedef std::allocator_traits<block_alloc> block_traits;
+
+  Alloc alloc;
+  const size_t limit;
+  std::atomic<Block *> spare{nullptr};
+
+  // producer side
+  alignas(kLine) std::atomic<size_t> tail{0};
+  Block *tail_block;
+  size_t head_cache = 0;
+
+  // consumer side
+  alignas(kLine) std::atomic<size_t> head{0};
+  Block *head_block;
+  size_t tail_cache = 0;
+
+  Block *NewBlock() {
+    Block *b = spare.exchange(nullptr, std::memory_order_acquire);
+    if (b) return b;
+    T *data = traits::allocate(alloc, kCap);
+    block_alloc ba(alloc);
+    try {
+      b = block_traits::allocate(ba, 1);
+    } catch (...) {
+      traits::deallocate(alloc, data, kCap);
+      throw;
+    }
+    ::new (static_cast<void *>(b)) Block(data);
+    return b;
+  }
+
+  void FreeBlock(Block *b) {
+    traits::deallocate(alloc, b->data, kCap);
+    b->~Block();
+    block_alloc ba(alloc);
+    block_traits::deallocate(ba, b, 1);
+  }
+
+  // consumer: hand a block it has read past back to the producer
+  void Retire(Block *b) {
+    b->next.store(nullptr, std::memory_order_relaxed);
+    b = spare.exchange(b, std::memory_order_release);
+    if (b) FreeBlock(b);
+  }
+
+public:
+  // at most max_size elements in flight; try_push_back fails beyond that
+  explicit spsc_deque(size_t max_size = size_t(-1)) : limit(max_size) {
+    tail_block = head_block = NewBlock();
+  }
+
+  spsc_deque(const spsc_deque &) = delete;
+  spsc_deque &operator=(const spsc_deque &) = delete;
+
+  // not concurrent with either end
+  ~spsc_deque() {
+    size_t h = head.load(std::memory_order_relaxed), t = tail.load(std::memory_order_relaxed);
+    Block *b = head_block;
+    for (; h != t; ++h) {
+      if ((h & (kCap - 1)) == 0 && h != 0) {  // same step as try_pop_front
+        Block *next = b->next.load(std::memory_order_relaxed);
+        FreeBlock(b);
+        b = next;
+      }
+      b->data[h & (kCap - 1)].~T();
+    }
+    while (b) {
+      Block *next = b->next.load(std::memory_order_relaxed);
+      FreeBlock(b);
+      b = next;
+    }
+    if (Block *s = spare.load(std::memory_order_relaxed)) FreeBlock(s);
+  }
+
+  /**
+   * producer only. constructs a new element behind the last one; returns
+   * false, without touching args, when max_size elements are in flight.
+   * throws whatever T's constructor or the allocator throws, leaving the
+   * deque unchanged.
+   */
+  template <class... Args>
+  bool try_emplace_back(Args &&...args) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head_cache >= limit) {
+      head_cache = head.load(std::memory_order_acquire);
+      if (t - head_cache >= limit) return false;
+    }
+    size_t i = t & (kCap - 1);
+    Block *b = tail_block;
+    if (i == 0 && t != 0) b = NewBlock();  // the tail block is full
+    try {
+      ::new (static_cast<void *>(b->data + i)) T(std::forward<Args>(args)...);
+    } catch (...) {
+      if (b != tail_block) FreeBlock(b);
+      throw;
+    }
+    if (b != tail_block) {
+      tail_block->next.store(b, std::memory_order_relaxed);  // published by the tail store below
+      tail_block = b;
+    }
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool try_push_back(const T &value) { return try_emplace_back(value); }
+  bool try_push_back(T &&value) { return try_emplace_back(std::move(value)); }
+
+  /**
+   * consumer only. moves the first element into out and removes it;
+   * returns false when the deque is empty.
+   */
+  bool try_pop_front(T &out) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h == tail_cache) {
+      tail_cache = tail.load(std::memory_order_acquire);
+      if (h == tail_cache) return false;
+    }
+    size_t i = h & (kCap - 1);
+    if (i == 0 && h != 0) {  // read past the head block
+      Block *next = head_block->next.load(std::memory_order_relaxed);
+      Retire(head_block);
+      head_block = next;
+    }
+    T &slot = head_block->data[i];
+    out = std::move(slot);
+    slot.~T();
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  // a snapshot; exact only when called from one of the two ends while the other is idle
+  size_t size() const {
+    size_t h = head.load(std::memory_order_acquire);
+    return tail.load(std::memory_order_acquire) - h;
+  }
+  bool empty() const { return size() == 0; }
+  size_t max_size() const { return limit; }
+};
+
+} // namespace sjtu
+
+#endif
@@ -0,0 +1,94 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <string>
+#include <type_traits>
+#include "deque.hpp"
+#include "exceptions.hpp"
+
+/***************************/
+int N = 1000000;
+/***************************/
+
+typedef sjtu::deque<int, std::allocator<int>, sjtu::fixed_block<64>> FixedDeque;
+typedef sjtu::deque<std::string, std::allocator<std::string>, sjtu::fixed_bytes<4096>> BytesDeque;
+static_assert(sjtu::fixed_bytes<4096>::capacity<int>::value == 1024, "4 KiB of int");
+static_assert(sjtu::fixed_bytes<4096>::capacity<char[48]>::value == 64, "rounded down to a power of two");
+static_assert(sjtu::fixed_bytes<16>::capacity<long long>::value == 8, "at least 8 per block");
+
+template <class D, class S>
+bool equal(const D &q, const S &stl){
+    if(q.size() != stl.size()) return 0;
+    for(size_t i = 0; i < stl.size(); i++)
+        if(q[i] != stl[i]) return 0;
+    return 1;
+}
+
+template <class D, class S, class Make>
+bool randomOps(D &q, S &stl, int n, Make make){
+    for(int i = 0; i < n; i++){
+        int op = rand() % 6;
+        if(op == 0) q.push_back(make(i)), stl.push_back(make(i));
+        else if(op == 1) q.push_front(make(i)), stl.push_front(make(i));
+        else if(op == 2){
+            size_t p = rand() % (stl.size() + 1);
+            q.insert(q.begin() + p, make(i)); stl.insert(stl.begin() + p, make(i));
+        }
+        else if(!stl.empty()){
+            size_t p = rand() % stl.size();
+            if(op == 3) q.erase(q.begin() + p), stl.erase(stl.begin() + p);
+            else if(op == 4) q.pop_front(), stl.pop_front();
+            else if(q[p] != stl[p]) return 0;
+        }
+    }
+    return equal(q, stl);
+}
+
+void test1(){
+    printf("test1: fixed_block correctness       ");
+    FixedDeque q;
+    std::deque<int> stl;
+    if(!randomOps(q, stl, 200000, [](int i){ return i; })) {puts("Wrong Answer");return;}
+    FixedDeque c(q);
+    if(!equal(c, stl)) {puts("Wrong Answer");return;}
+    q.clear(); stl.clear();
+    if(!q.empty() || !randomOps(q, stl, 1000, [](int i){ return i; })) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test2(){
+    printf("test2: fixed_bytes correctness       ");
+    BytesDeque q;
+    std::deque<std::string> stl;
+    if(!randomOps(q, stl, 100000, [](int i){ return std::to_string(i); })) {puts("Wrong Answer");return;}
+    BytesDeque c;
+    c.set_copy_on_write(true);
+    c = q;
+    BytesDeque snap(c);
+    c.push_back("x");
+    c.erase(c.begin() + c.size() / 2);
+    if(!equal(snap, stl) || c.size() != stl.size()) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test3(){
+    printf("test3: complexity                    ");
+    FixedDeque q;
+    for(int i = 0; i < N * 10; i++){
+        if(i % 2) q.push_back(i);
+        else q.push_front(i);
+    }
+    long long sum = 0;
+    for(int k = 0; k < 10; k++)
+        for(FixedDeque::iterator it = q.begin(); it != q.end(); ++it) sum += *it;
+    for(int i = 0; i < N * 10; i++) q.pop_front();
+    if(sum != 10LL * N * 10 / 2 * (N * 10 - 1) || !q.empty()) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//fixed element capacity
+    test2();//fixed byte budget
+    test3();//complexity
+}
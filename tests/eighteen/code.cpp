@@ -0,0 +1,117 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <vector>
+#include "deque.hpp"
+#include "exceptions.hpp"
+
+/***************************/
+int N = 200000;
+/***************************/
+
+typedef sjtu::deque<int> Deque;
+
+bool equal(const Deque &q, const std::deque<int> &stl){
+    if(q.size() != stl.size()) return 0;
+    for(size_t i = 0; i < stl.size(); i++)
+        if(q[i] != stl[i]) return 0;
+    return 1;
+}
+void fill(Deque &q, std::deque<int> &stl, int n){
+    for(int i = 0; i < n; i++){
+        int x = rand();
+        if(i % 2) q.push_back(x), stl.push_back(x);
+        else q.push_front(x), stl.push_front(x);
+    }
+}
+
+long long copies = 0, moves = 0;
+class Counted{
+public:
+    int data;
+    Counted(int data) : data(data) {}
+    Counted(const Counted &other) : data(other.data) { copies++; }
+    Counted(Counted &&other) : data(other.data) { moves++; }
+    Counted &operator=(const Counted &other) { data = other.data; copies++; return *this; }
+    Counted &operator=(Counted &&other) { data = other.data; moves++; return *this; }
+};
+
+void test1(){
+    printf("test1: append and concat             ");
+    Deque q;
+    std::deque<int> stl;
+    for(int round = 0; round < 200; round++){
+        Deque part;
+        std::deque<int> spart;
+        fill(part, spart, rand() % (N / 100));
+        if(round % 2) q.append(std::move(part));
+        else q = sjtu::concat(std::move(q), std::move(part));
+        stl.insert(stl.end(), spart.begin(), spart.end());
+        if(!part.empty() || part.begin() != part.end()) {puts("Wrong Answer");return;}
+        if(round % 20 == 0 && !equal(q, stl)) {puts("Wrong Answer");return;}
+        part.push_back(round);  // a drained deque is still usable
+        if(part.size() != 1 || part[0] != round) {puts("Wrong Answer");return;}
+    }
+    q.append(std::move(q));
+    for(int i = 0; i < N / 10; i++){
+        size_t pos = rand() % (stl.size() + 1);
+        q.insert(q.begin() + pos, i), stl.insert(stl.begin() + pos, i);
+    }
+    if(!equal(q, stl)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test2(){
+    printf("test2: split_at                      ");
+    Deque q;
+    std::deque<int> stl;
+    fill(q, stl, N);
+    std::vector<Deque> parts;
+    std::vector<std::deque<int> > sparts;
+    while(!stl.empty()){
+        size_t pos = stl.size() > 100 ? rand() % stl.size() : 0;
+        parts.push_back(q.split_at(pos));
+        sparts.push_back(std::deque<int>(stl.begin() + pos, stl.end()));
+        stl.erase(stl.begin() + pos, stl.end());
+        if(!equal(q, stl) || !equal(parts.back(), sparts.back())) {puts("Wrong Answer");return;}
+    }
+    bool caught = false;
+    try{
+        q.push_back(1);
+        q.split_at(2);
+    } catch(std::out_of_range &){
+        caught = true;
+    }
+    if(!caught || q.size() != 1 || !q.split_at(1).empty()) {puts("Wrong Answer");return;}
+    stl.push_back(1);
+    for(size_t i = parts.size(); i-- > 0;){  // glue the pieces back together
+        parts[i].push_front(-1), sparts[i].push_front(-1);
+        q.append(std::move(parts[i]));
+        stl.insert(stl.end(), sparts[i].begin(), sparts[i].end());
+    }
+    if(!equal(q, stl)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test3(){
+    printf("test3: no element copies             ");
+    sjtu::deque<Counted> q, tail;
+    for(int i = 0; i < N; i++) q.push_back(Counted(i));
+    for(int i = 0; i < N; i++) tail.push_back(Counted(N + i));
+    copies = moves = 0;
+    q.append(std::move(tail));
+    sjtu::deque<Counted> back = q.split_at(N / 2 + 7);
+    back = q.split_at(N / 3);
+    if(copies != 0 || moves > N / 20) {puts("Wrong Answer");return;}
+    if(q.size() != size_t(N / 3) || back.size() != size_t(N / 2 + 7 - N / 3)) {puts("Wrong Answer");return;}
+    for(int i = 0; i < N / 3; i++) if(q[i].data != i) {puts("Wrong Answer");return;}
+    for(size_t i = 0; i < back.size(); i++) if(back[i].data != int(N / 3 + i)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//against std::deque
+    test2();//against std::deque
+    test3();//blocks change hands as they are
+}
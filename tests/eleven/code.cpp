@@ -0,0 +1,127 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "deque.hpp"
+#include "concurrent_deque.hpp"
+#include "exceptions.hpp"
+
+// define __BENCH to print the throughput of test3
+// #define __BENCH
+
+/***************************/
+int N = 1000000;
+/***************************/
+
+typedef sjtu::concurrent_deque<int, std::allocator<int>, sjtu::fixed_block<16>> Small;
+
+void test1(){
+    printf("test1: single thread                 ");
+    Small q;
+    std::deque<int> stl;
+    int out;
+    for(int i = 0; i < 200000; i++){
+        int op = rand() % 4;
+        if(op == 0) q.push_back(i), stl.push_back(i);
+        else if(op == 1) q.push_front(i), stl.push_front(i);
+        else if(op == 2){
+            bool ok = q.try_pop_front(out);
+            if(ok != !stl.empty() || (ok && out != stl.front())) {puts("Wrong Answer");return;}
+            if(ok) stl.pop_front();
+        } else {
+            bool ok = q.try_pop_back(out);
+            if(ok != !stl.empty() || (ok && out != stl.back())) {puts("Wrong Answer");return;}
+            if(ok) stl.pop_back();
+        }
+        if(q.size() != stl.size()) {puts("Wrong Answer");return;}
+    }
+    sjtu::concurrent_deque<std::string> s;
+    for(int i = 0; i < 5000; i++) s.emplace_front(5, char('a' + i % 26)), s.push_back(std::to_string(i));
+    std::string str;
+    if(!s.try_pop_back(str) || str != "4999" || !s.try_pop_front(str) || str != "hhhhh") {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+
+// every value pushed is popped exactly once, by pops at both ends
+void test2(){
+    printf("test2: producers and consumers       ");
+    Small q;
+    const int P = 2, C = 2;
+    std::atomic<int> popped(0);
+    std::vector<std::vector<int>> got(C);
+    std::vector<std::thread> threads;
+    for(int p = 0; p < P; p++)
+        threads.emplace_back([&q, p](){
+            for(int i = p; i < N; i += P){
+                if(i % 2) q.push_back(i);
+                else q.push_front(i);
+            }
+        });
+    for(int c = 0; c < C; c++)
+        threads.emplace_back([&, c](){
+            int v;
+            while(popped.load() < N){
+                if(c ? q.try_pop_back(v) : q.try_pop_front(v)) got[c].push_back(v), popped++;
+                else std::this_thread::yield();
+            }
+        });
+    for(auto &t : threads) t.join();
+    std::vector<char> seen(N, 0);
+    for(auto &g : got)
+        for(int x : g){
+            if(x < 0 || x >= N || seen[x]) {puts("Wrong Answer");return;}
+            seen[x] = 1;
+        }
+    if(!q.empty()) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+
+// one thread per end, each pushing and popping its own end
+template <class PushF, class PopF, class PushB, class PopB>
+double twoEnds(PushF pushf, PopF popf, PushB pushb, PopB popb){
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::thread front([&](){
+        int v;
+        for(int i = 0; i < N; i++){ pushf(i); if(i % 4 == 3) for(int k = 0; k < 3; k++) popf(v); }
+    });
+    int v;
+    for(int i = 0; i < N; i++){ pushb(i); if(i % 4 == 3) for(int k = 0; k < 3; k++) popb(v); }
+    front.join();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void test3(){
+    printf("test3: two-ended throughput          ");
+    sjtu::concurrent_deque<int> q;
+    for(int i = 0; i < 100000; i++) q.push_back(i);
+    double split = twoEnds([&](int x){ q.push_front(x); }, [&](int &x){ return q.try_pop_front(x); },
+                           [&](int x){ q.push_back(x); }, [&](int &x){ return q.try_pop_back(x); });
+    sjtu::deque<int> d;
+    std::mutex m;
+    for(int i = 0; i < 100000; i++) d.push_back(i);
+    double global = twoEnds([&](int x){ std::lock_guard<std::mutex> g(m); d.push_front(x); },
+                            [&](int &x){ std::lock_guard<std::mutex> g(m); x = d.front(); d.pop_front(); return true; },
+                            [&](int x){ std::lock_guard<std::mutex> g(m); d.push_back(x); },
+                            [&](int &x){ std::lock_guard<std::mutex> g(m); x = d.back(); d.pop_back(); return true; });
+    if(q.size() != d.size()) {puts("Wrong Answer");return;}
+#ifdef __BENCH
+    printf("front/back locks %.3fs, one lock %.3fs ", split, global);
+#else
+    (void)split; (void)global;
+#endif
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//against std::deque
+    test2();//MPMC
+    test3();//against a mutex-wrapped sjtu::deque
+}
@@ -0,0 +1,127 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <string>
+#define SJTU_DEQUE_PROFILE 1
+#include "deque.hpp"
+#include "exceptions.hpp"
+
+/***************************/
+int N = 200000;
+/***************************/
+
+typedef sjtu::deque<int> Deque;
+typedef sjtu::deque_profile::series Series;
+
+// the histogram of s accounts for all of its values
+bool consistent(const Series &s){
+    unsigned long long sum = 0;
+    for(size_t b = 0; b < sjtu::deque_profile::kBuckets; b++) sum += s.histogram[b];
+    if(sum != s.count) return 0;
+    if(s.count == 0) return s.total == 0 && s.max == 0;
+    return s.max <= s.total && s.mean() <= s.max;
+}
+bool consistent(const sjtu::deque_profile &p){
+    return consistent(p.balance) && consistent(p.split) && consistent(p.merge) && consistent(p.reindex)
+        && consistent(p.at_walk) && consistent(p.insert_walk) && consistent(p.erase_walk);
+}
+
+size_t ats = 0, inserts = 0, erases = 0;
+void workload(Deque &q, std::deque<int> &stl, int n){
+    for(int i = 0; i < n; i++){
+        int x = rand();
+        if(i % 4 == 0) q.push_front(x), stl.push_front(x);
+        else if(i % 4 == 1 && !stl.empty()){
+            size_t pos = rand() % (stl.size() + 1);
+            q.insert(q.begin() + pos, x), stl.insert(stl.begin() + pos, x);
+            inserts++;
+        }
+        else if(i % 4 == 2 && !stl.empty()){
+            size_t pos = rand() % stl.size();
+            q.erase(q.begin() + pos), stl.erase(stl.begin() + pos);
+            erases++;
+        }
+        else q.push_back(x), stl.push_back(x);
+        if(!stl.empty()){
+            size_t pos = rand() % stl.size();
+            if(q[pos] != stl[pos]) throw 0;
+            ats++;
+        }
+    }
+}
+void test1(){
+    printf("test1: counters and walks            ");
+    Deque q;
+    std::deque<int> stl;
+    ats = inserts = erases = 0;
+    workload(q, stl, N);
+    while(stl.size() > 10) q.pop_back(), stl.pop_back();
+    const sjtu::deque_profile &p = q.profile();
+    if(!consistent(p)) {puts("Wrong Answer");return;}
+    if(p.at_walk.count != ats || p.insert_walk.count != inserts || p.erase_walk.count != erases)
+        {puts("Wrong Answer");return;}
+    if(p.split.count + p.merge.count != q.memory_stats().rebalances) {puts("Wrong Answer");return;}
+    if(p.split.count == 0 || p.merge.count == 0 || p.balance.count == 0 || p.reindex.count == 0)
+        {puts("Wrong Answer");return;}
+    // a binary search over at most N blocks
+    if(p.at_walk.max > 20) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+
+std::map<std::string, unsigned long long> seen;
+void hook(const char *name, std::uint64_t, void *context){
+    seen[name]++;
+    ++*static_cast<int *>(context);
+}
+void test2(){
+    printf("test2: hook                          ");
+    int calls = 0;
+    seen.clear();
+    sjtu::deque_profile::set_hook(hook, &calls);
+    Deque a, b;
+    std::deque<int> sa, sb;
+    workload(a, sa, N / 4);
+    workload(b, sb, N / 4);
+    sjtu::deque_profile::set_hook(nullptr);
+    sjtu::deque_profile p = a.profile(), r = b.profile();
+    workload(a, sa, 1000);  // no longer reported
+    const char *names[] = {"balance", "split", "merge", "reindex", "at_walk", "insert_walk", "erase_walk"};
+    const Series *mine[] = {&p.balance, &p.split, &p.merge, &p.reindex, &p.at_walk, &p.insert_walk, &p.erase_walk};
+    const Series *theirs[] = {&r.balance, &r.split, &r.merge, &r.reindex, &r.at_walk, &r.insert_walk, &r.erase_walk};
+    unsigned long long total = 0;
+    for(int i = 0; i < 7; i++){
+        if(seen[names[i]] != mine[i]->count + theirs[i]->count) {puts("Wrong Answer");return;}
+        total += seen[names[i]];
+    }
+    if(seen.size() != 7 || total != (unsigned long long)calls) {puts("Wrong Answer");return;}
+    if(a.profile().at_walk.count <= p.at_walk.count) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test3(){
+    printf("test3: reset and swap                ");
+    Deque a, b;
+    std::deque<int> sa, sb;
+    workload(a, sa, N / 4);
+    sjtu::deque_profile before = a.profile();
+    a.swap(b);
+    if(b.profile().at_walk.count != before.at_walk.count || a.profile().at_walk.count != 0)
+        {puts("Wrong Answer");return;}
+    b.reset_profile();
+    if(b.profile().at_walk.count != 0 || b.profile().balance.count != 0 || !consistent(b.profile()))
+        {puts("Wrong Answer");return;}
+    for(size_t i = 0; i < sa.size(); i++) if(b.at(i) != sa[i]) {puts("Wrong Answer");return;}
+    if(b.profile().at_walk.count != sa.size()) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//every series adds up
+    test2();//process-wide hook
+    test3();//per-deque counters
+}
@@ -0,0 +1,140 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <vector>
+#include <sstream>
+#include <iterator>
+#include "deque.hpp"
+#include "exceptions.hpp"
+
+/***************************/
+int N = 100000;
+/***************************/
+
+class T{
+private:
+    int x;
+public:
+    T(int x):x(x){}
+    int num()const {return x;}
+};
+bool operator == (const T &a, const T &b){
+    return a.num() == b.num();
+}
+bool operator != (const T &a, const T &b){
+    return a.num() != b.num();
+}
+sjtu::deque<T> q;
+std::deque<T> stl;
+bool equal(){
+    if(q.size() != stl.size()) return 0;
+    if(q.empty() != stl.empty()) return 0;
+    for(size_t i = 0; i < stl.size(); i++)
+        if(q[i] != stl[i]) return 0;
+    if(!stl.empty() && (q.front() != stl.front() || q.back() != stl.back())) return 0;
+    return 1;
+}
+std::vector<T> make(int n, int base){
+    std::vector<T> v;
+    for(int i = 0; i < n; i++) v.push_back(T(base + i));
+    return v;
+}
+void test1(){
+    printf("test1: range constructor & assign    ");
+    std::vector<T> v = make(N, 0);
+    sjtu::deque<T> r(v.begin(), v.end());
+    q = r;
+    stl.assign(v.begin(), v.end());
+    if(!equal()) {puts("Wrong Answer");return;}
+    q.assign(1000, T(7));
+    stl.assign(1000, T(7));
+    if(!equal()) {puts("Wrong Answer");return;}
+    std::istringstream in("1 2 3 4 5 6 7 8 9 10");
+    q.assign(std::istream_iterator<int>(in), std::istream_iterator<int>());
+    stl.clear();
+    for(int i = 1; i <= 10; i++) stl.push_back(T(i));
+    if(!equal()) {puts("Wrong Answer");return;}
+    sjtu::deque<T> f(5, T(3));
+    if(f.size() != 5 || f[4] != T(3)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test2(){
+    printf("test2: range insert                  ");
+    q.clear(); stl.clear();
+    for(int i = 0; i < 200; i++){
+        size_t pos = rand() % (stl.size() + 1);
+        int n = rand() % 300 + 1;
+        std::vector<T> v = make(n, i * 1000);
+        sjtu::deque<T>::iterator it = q.insert(q.begin() + pos, v.begin(), v.end());
+        stl.insert(stl.begin() + pos, v.begin(), v.end());
+        if(size_t(it - q.begin()) != pos || *it != v[0]) {puts("Wrong Answer");return;}
+        pos = rand() % (stl.size() + 1);
+        n = rand() % 30 + 1;
+        it = q.insert(q.begin() + pos, n, T(-i));
+        stl.insert(stl.begin() + pos, n, T(-i));
+        if(size_t(it - q.begin()) != pos || *it != T(-i)) {puts("Wrong Answer");return;}
+    }
+    q.insert(q.begin() + 5, q[0]);
+    stl.insert(stl.begin() + 5, stl[0]);
+    q.insert(q.begin() + 5, 3, q[6]);
+    stl.insert(stl.begin() + 5, 3, stl[6]);
+    if(!equal()) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test3(){
+    printf("test3: range erase                   ");
+    while(stl.size() > 10){
+        size_t a = rand() % (stl.size() + 1), b = rand() % (stl.size() + 1);
+        if(a > b) std::swap(a, b);
+        if(b - a > stl.size() / 4) b = a + stl.size() / 4;
+        sjtu::deque<T>::iterator it = q.erase(q.begin() + a, q.begin() + b);
+        stl.erase(stl.begin() + a, stl.begin() + b);
+        if(size_t(it - q.begin()) != a) {puts("Wrong Answer");return;}
+        if(a < stl.size() && *it != stl[a]) {puts("Wrong Answer");return;}
+        if(a == stl.size() && it != q.end()) {puts("Wrong Answer");return;}
+        if(!equal()) {puts("Wrong Answer");return;}
+    }
+    q.erase(q.begin(), q.end());
+    stl.clear();
+    if(!equal() || q.begin() != q.end()) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test4(){
+    printf("test4: invalid ranges                ");
+    q.assign(10, T(1));
+    sjtu::deque<T> other(10, T(1));
+    int caught = 0;
+    try { q.erase(q.begin() + 5, q.begin() + 2); } catch(...) { caught++; }
+    try { q.erase(other.begin(), other.end()); } catch(...) { caught++; }
+    try { q.insert(other.begin(), 3, T(2)); } catch(...) { caught++; }
+    if(caught != 3 || q.size() != 10) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test5(){
+    printf("test5: complexity                    ");
+    std::vector<T> v = make(4000000, 0);
+    for(int k = 0; k < 5; k++){
+        q.assign(v.begin(), v.end());
+        q.insert(q.begin() + q.size() / 2, v.begin(), v.begin() + 1000000);
+        q.erase(q.begin() + 1000, q.end() - 1000);
+    }
+    if(q.size() != 2000) {puts("Wrong Answer");return;}
+    // truncating rebalances like every other erase: the block size follows the new size
+    q.assign(v.begin(), v.end());
+    size_t before = q.memory_stats().block_size;
+    q.erase(q.begin() + 100, q.end());
+    if(q.size() != 100 || q.memory_stats().block_size != sjtu::pow2_balance::block_size(100, before))
+        {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//range constructor & assign
+    test2();//range insert
+    test3();//range erase
+    test4();//invalid ranges
+    test5();//complexity
+}
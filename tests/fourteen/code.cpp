@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <iterator>
+#include <new>
+#include <string>
+#include "deque.hpp"
+#include "class-matrix.hpp"
+#include "class-bint.hpp"
+
+// define __BENCH to also run the benchmark table: every workload for every
+// element type at 10^3 .. 10^8 elements (capped per type, and by the first
+// command-line argument), sjtu::deque against std::deque
+// #define __BENCH
+
+// operator new calls so far; every workload reports the calls it made per operation
+static long long allocations = 0;
+
+void *operator new(size_t size) {
+    ++allocations;
+    void *p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+class Int{
+private:
+    int data;
+
+public:
+    Int() = default;
+    Int(const int &data) : data(data) {}
+    Int & operator =(const Int &rhs) = default;
+    bool operator ==(const Int &rhs)const {
+        return data == rhs.data;
+    }
+};
+
+int liveDynamic = 0;
+
+class DynamicType {
+public:
+    int *pct;
+    double *data;
+    DynamicType (int *p, double x) : pct(p) , data(new double[2]) {
+        data[0] = x;
+        (*pct)++;
+    }
+    DynamicType (const DynamicType &other) : pct(other.pct), data(new double[2]) {
+        data[0] = other.data[0];
+        (*pct)++;
+    }
+    DynamicType &operator =(const DynamicType &other) {
+        if (this == &other) return *this;
+        data[0] = other.data[0];
+        return *this;
+    }
+    ~DynamicType() {
+        delete [] data;
+        (*pct)--;
+    }
+    bool operator ==(const DynamicType &rhs) const { return data[0] == rhs.data[0]; }
+};
+
+typedef Diamond::Matrix<double> Matrix;
+
+// name, largest benchmarked size and the i-th value of every element type
+template<class T> struct Element;
+template<> struct Element<Int> {
+    static const char *name() { return "Int"; }
+    static size_t limit() { return 100000000; }
+    static Int make(size_t i) { return Int(int(i)); }
+};
+template<> struct Element<DynamicType> {
+    static const char *name() { return "DynamicType"; }
+    static size_t limit() { return 10000000; }
+    static DynamicType make(size_t i) { return DynamicType(&liveDynamic, double(i)); }
+};
+template<> struct Element<Util::Bint> {
+    static const char *name() { return "Bint"; }
+    static size_t limit() { return 10000; }  // every Bint owns an 8 KB digit buffer
+    static Util::Bint make(size_t i) { return Util::Bint(int(i)); }
+};
+template<> struct Element<Matrix> {
+    static const char *name() { return "Matrix<double>"; }
+    static size_t limit() { return 1000000; }
+    static Matrix make(size_t i) { return Matrix(2, 2, double(i)); }
+};
+
+// keeps a read the compiler could prove unused (like benchmark::DoNotOptimize)
+template<class T> inline void keep(const T &x) { asm volatile("" : : "r"(&x) : "memory"); }
+
+enum Workload { PushBack, PushFront, PopBack, PopFront, RandomAt, InsertMiddle, EraseMiddle, Iterate, kWorkloads };
+const char *workloadName[kWorkloads] = {
+    "push_back", "push_front", "pop_back", "pop_front", "random_at", "insert_middle", "erase_middle", "iterate"
+};
+
+// operations one run of w makes on n elements; the middle ones cost O(n) each on std::deque
+size_t operations(Workload w, size_t n) {
+    if (w == InsertMiddle || w == EraseMiddle) return std::min(n / 2, std::max<size_t>(10, 10000000 / n));
+    return n;
+}
+
+// the container a run of w starts from
+template<class C>
+void setup(C &c, Workload w, size_t n) {
+    typedef typename std::iterator_traits<typename C::iterator>::value_type T;
+    c.clear();
+    if (w == PushBack || w == PushFront) return;
+    for (size_t i = 0; i < n; i++) c.push_back(Element<T>::make(i));
+}
+
+// the timed part; element construction is part of a push, as it would be for a caller
+template<class C>
+void body(C &c, Workload w, size_t n, size_t ops) {
+    typedef typename std::iterator_traits<typename C::iterator>::value_type T;
+    switch (w) {
+    case PushBack:
+        for (size_t i = 0; i < ops; i++) c.push_back(Element<T>::make(i));
+        break;
+    case PushFront:
+        for (size_t i = 0; i < ops; i++) c.push_front(Element<T>::make(i));
+        break;
+    case PopBack:
+        for (size_t i = 0; i < ops; i++) c.pop_back();
+        break;
+    case PopFront:
+        for (size_t i = 0; i < ops; i++) c.pop_front();
+        break;
+    case RandomAt: {
+        unsigned long long x = 88172645463325252ull;  // xorshift64, the same sequence for both containers
+        for (size_t i = 0; i < ops; i++) {
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+            keep(c[x % n]);
+        }
+        break;
+    }
+    case InsertMiddle:
+        for (size_t i = 0; i < ops; i++) c.insert(c.begin() + c.size() / 2, Element<T>::make(i));
+        break;
+    case EraseMiddle:
+        for (size_t i = 0; i < ops; i++) c.erase(c.begin() + c.size() / 2);
+        break;
+    case Iterate:
+        for (typename C::iterator it = c.begin(); it != c.end(); ++it) keep(*it);
+        break;
+    default:
+        break;
+    }
+}
+
+template<class T>
+bool same(sjtu::deque<T> &a, std::deque<T> &b) {
+    if (a.size() != b.size()) return false;
+    typename sjtu::deque<T>::iterator it = a.begin();
+    for (size_t i = 0; i < b.size(); i++, ++it)
+        if (!(a[i] == b[i]) || !(*it == b[i])) return false;
+    return it == a.end();
+}
+
+// every workload once at n elements on both containers, which must end up equal
+template<class T>
+bool check(size_t n) {
+    for (int w = 0; w < kWorkloads; w++) {
+        sjtu::deque<T> a;
+        std::deque<T> b;
+        setup(a, Workload(w), n);
+        setup(b, Workload(w), n);
+        body(a, Workload(w), n, operations(Workload(w), n));
+        body(b, Workload(w), n, operations(Workload(w), n));
+        if (!same(a, b)) return false;
+    }
+    return true;
+}
+
+template<class T>
+void test(int id) {
+    std::string title = std::string(Element<T>::name()) + " workloads";
+    printf("test%d: %-37s", id, title.c_str());
+    for (size_t n = 1000; n <= 10000; n *= 10)
+        if (!check<T>(n)) {puts("Wrong Answer");return;}
+    if (liveDynamic != 0) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+
+#ifdef __BENCH
+struct Result {
+    double seconds;  // wall clock, over all repetitions
+    size_t ops;
+    long long allocations;
+    double ns() const { return seconds * 1e9 / ops; }
+    double allocs() const { return double(allocations) / ops; }
+};
+
+// reps runs of w on n elements; only body() is timed
+template<class C>
+Result measure(Workload w, size_t n, size_t reps) {
+    typedef std::chrono::steady_clock clock;
+    Result r = {0, 0, 0};
+    C c;
+    for (size_t rep = 0; rep < reps; rep++) {
+        setup(c, w, n);
+        size_t ops = operations(w, n);
+        long long before = allocations;
+        clock::time_point t0 = clock::now();
+        body(c, w, n, ops);
+        clock::time_point t1 = clock::now();
+        r.allocations += allocations - before;
+        r.seconds += std::chrono::duration<double>(t1 - t0).count();
+        r.ops += ops;
+    }
+    return r;
+}
+
+template<class T>
+void bench(size_t maxN) {
+    for (size_t n = 1000; n <= std::min(maxN, Element<T>::limit()); n *= 10) {
+        // small sizes repeat, so that every row does about the same work
+        size_t reps = std::max<size_t>(1, std::min<size_t>(Element<T>::limit(), 1000000) / n);
+        for (int w = 0; w < kWorkloads; w++) {
+            Result mine = measure<sjtu::deque<T> >(Workload(w), n, reps);
+            Result theirs = measure<std::deque<T> >(Workload(w), n, reps);
+            std::string name = std::string(workloadName[w]) + "<" + Element<T>::name() + ">/" + std::to_string(n);
+            printf("%-36s %11.3f %10.2f %10.3f %10.2f %10.3f %7.2f\n", name.c_str(), mine.seconds * 1e3 / reps,
+                   mine.ns(), mine.allocs(), theirs.ns(), theirs.allocs(), mine.ns() / theirs.ns());
+        }
+    }
+}
+#endif
+
+int main(int argc, char *argv[]) {
+    puts("test start:");
+    test<Int>(1);//against std::deque, 10^3 and 10^4 elements
+    test<DynamicType>(2);
+    test<Util::Bint>(3);
+    test<Matrix>(4);
+#ifdef __BENCH
+    size_t maxN = argc > 1 ? strtoull(argv[1], NULL, 10) : 100000000;
+    // Time: wall clock of one run, in ms; ratio: sjtu ns/op over std ns/op
+    printf("%-36s %11s %10s %10s %10s %10s %7s\n", "Benchmark", "Time(ms)", "ns/op", "allocs/op", "std ns/op",
+           "std allocs", "ratio");
+    bench<Int>(maxN);
+    bench<DynamicType>(maxN);
+    bench<Util::Bint>(maxN);
+    bench<Matrix>(maxN);
+#else
+    (void)argc, (void)argv;
+#endif
+}
@@ -0,0 +1,73 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <thread>
+#include "spsc_deque.hpp"
+#include "exceptions.hpp"
+
+/***************************/
+int N = 10000000;
+/***************************/
+
+typedef sjtu::spsc_deque<int, std::allocator<int>, sjtu::fixed_block<64>> Queue;
+
+void test1(){
+    printf("test1: single thread                 ");
+    Queue q(1000);
+    int out = -1;
+    if(!q.empty() || q.try_pop_front(out) || out != -1) {puts("Wrong Answer");return;}
+    for(int round = 0; round < 50; round++){
+        for(int i = 0; i < 1000; i++)
+            if(!q.try_push_back(round * 1000 + i)) {puts("Wrong Answer");return;}
+        if(q.try_push_back(0) || q.size() != 1000) {puts("Wrong Answer");return;}
+        for(int i = 0; i < 1000; i++)
+            if(!q.try_pop_front(out) || out != round * 1000 + i) {puts("Wrong Answer");return;}
+    }
+    if(!q.empty() || q.try_pop_front(out)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test2(){
+    printf("test2: producer and consumer         ");
+    Queue q(4096);
+    std::thread producer([&q](){
+        for(int i = 0; i < N; i++)
+            while(!q.try_push_back(i)) std::this_thread::yield();
+    });
+    bool ok = true;
+    for(int i = 0; i < N; i++){
+        int out;
+        while(!q.try_pop_front(out)) std::this_thread::yield();
+        if(out != i) ok = false;
+    }
+    producer.join();
+    if(!ok || !q.empty()) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test3(){
+    printf("test3: non-trivial elements          ");
+    bool ok = true;
+    {
+        sjtu::spsc_deque<std::string> q;
+        std::thread producer([&q](){
+            for(int i = 0; i < N / 10; i++) q.try_push_back(std::to_string(i));
+        });
+        int next = 0;
+        std::string out;
+        while(next < N / 20){
+            if(q.try_pop_front(out)) ok = ok && out == std::to_string(next++);
+        }
+        producer.join();
+        ok = ok && q.size() == size_t(N / 10 - N / 20);
+    }  // the rest is destroyed with the queue
+    if(!ok) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//bounded, one thread
+    test2();//two threads
+    test3();//strings, leftovers destroyed
+}
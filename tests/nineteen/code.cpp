@@ -0,0 +1,117 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <string>
+#include "deque.hpp"
+#include "exceptions.hpp"
+
+/***************************/
+int N = 100000;
+/***************************/
+
+// small blocks, so that the tree index gets a few levels
+typedef sjtu::deque<int, std::allocator<int>, sjtu::tree_blocks<64> > Deque;
+
+template<class Q, class S>
+bool equal(const Q &q, const S &stl){
+    if(q.size() != stl.size()) return 0;
+    for(size_t i = 0; i < stl.size(); i++)
+        if(!(q[i] == stl[i])) return 0;
+    return 1;
+}
+void test1(){
+    printf("test1: tree index workload           ");
+    Deque q;
+    std::deque<int> stl;
+    for(int i = 0; i < 4 * N; i++){
+        int op = rand() % 8, x = rand();
+        bool grow = i < 2 * N;
+        if(op == 0 && (grow || i % 3 == 0)) q.push_back(x), stl.push_back(x);
+        else if(op == 1 && (grow || i % 3 == 0)) q.push_front(x), stl.push_front(x);
+        else if(op == 2 && !stl.empty()) q.pop_back(), stl.pop_back();
+        else if(op == 3 && !stl.empty()) q.pop_front(), stl.pop_front();
+        else if(op == 4 && (grow || i % 3 == 0)){
+            size_t pos = rand() % (stl.size() + 1);
+            q.insert(q.begin() + pos, x), stl.insert(stl.begin() + pos, x);
+        }
+        else if(!stl.empty()){
+            size_t pos = rand() % stl.size();
+            q.erase(q.begin() + pos), stl.erase(stl.begin() + pos);
+        }
+        if(!stl.empty()){
+            size_t pos = rand() % stl.size();
+            if(q[pos] != stl[pos] || q.at(pos) != stl[pos]) {puts("Wrong Answer");return;}
+        }
+        if(i % 50000 == 0 && !equal(q, stl)) {puts("Wrong Answer");return;}
+    }
+    if(!equal(q, stl)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test2(){
+    printf("test2: iterators, cursors and splits ");
+    Deque q;
+    std::deque<int> stl;
+    for(int i = 0; i < N; i++) q.push_back(i), stl.push_back(i);
+    for(int round = 0; round < 1000; round++){
+        size_t a = rand() % (stl.size() + 1), b = rand() % (stl.size() + 1);
+        Deque::iterator ia = q.begin() + a, ib = q.end() - (stl.size() - b);
+        if(ia - ib != long(a) - long(b) || ia.index() != a) {puts("Wrong Answer");return;}
+        if(a < stl.size() && *ia != stl[a]) {puts("Wrong Answer");return;}
+    }
+    Deque::cursor c = q.cursor_at(N / 2);
+    size_t p = N / 2;
+    for(int k = 0; k < N; k++){
+        int x = rand();
+        if(rand() % 2) c.insert_before(x), stl.insert(stl.begin() + p, x), p++;
+        else if(p < stl.size()) c.erase_at(), stl.erase(stl.begin() + p);
+        if(rand() % 4 == 0) c.move_by(-long(p > 3 ? 3 : p)), p -= p > 3 ? 3 : p;
+    }
+    if(c.index() != p || !equal(q, stl)) {puts("Wrong Answer");return;}
+    Deque back = q.split_at(stl.size() / 3);
+    std::deque<int> sback(stl.begin() + stl.size() / 3, stl.end());
+    stl.erase(stl.begin() + stl.size() / 3, stl.end());
+    if(!equal(q, stl) || !equal(back, sback)) {puts("Wrong Answer");return;}
+    back.push_front(-1), sback.push_front(-1);
+    q.append(std::move(back));
+    stl.insert(stl.end(), sback.begin(), sback.end());
+    for(int k = 0; k < N / 10; k++){
+        size_t pos = rand() % (stl.size() + 1);
+        q.insert(q.begin() + pos, k), stl.insert(stl.begin() + pos, k);
+    }
+    if(!equal(q, stl)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test3(){
+    printf("test3: tree index with strings       ");
+    sjtu::deque<std::string, std::allocator<std::string>, sjtu::tree_blocks<256> > q;
+    std::deque<std::string> stl;
+    for(int i = 0; i < N; i++){
+        std::string x = std::to_string(rand()) + "-padding-beyond-short-strings";
+        int op = rand() % 4;
+        if(op == 0) q.push_back(x), stl.push_back(x);
+        else if(op == 1) q.push_front(x), stl.push_front(x);
+        else if(op == 2){
+            size_t pos = rand() % (stl.size() + 1);
+            q.insert(q.begin() + pos, x), stl.insert(stl.begin() + pos, x);
+        }
+        else if(!stl.empty()){
+            size_t pos = rand() % stl.size();
+            q.erase(q.begin() + pos), stl.erase(stl.begin() + pos);
+        }
+    }
+    if(!equal(q, stl)) {puts("Wrong Answer");return;}
+    sjtu::deque<std::string, std::allocator<std::string>, sjtu::tree_blocks<256> > copy(q);
+    std::deque<std::string> snapshot(stl);
+    while(!stl.empty()) q.pop_front(), stl.pop_front();
+    if(!q.empty() || !equal(copy, snapshot)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//against std::deque
+    test2();//against std::deque
+    test3();//against std::deque
+}
@@ -0,0 +1,134 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include <iterator>
+#include <random>
+#include <type_traits>
+#include "deque.hpp"
+#include "deque_algorithm.hpp"
+#include "exceptions.hpp"
+
+/***************************/
+int N = 1000000;
+/***************************/
+
+typedef sjtu::deque<int> Deque;
+static_assert(std::is_same<std::iterator_traits<Deque::iterator>::iterator_category,
+                           std::random_access_iterator_tag>::value, "iterator category");
+static_assert(std::is_same<std::iterator_traits<Deque::const_iterator>::reference,
+                           const int &>::value, "const_iterator reference");
+
+Deque q;
+std::deque<int> stl;
+bool equal(){
+    if(q.size() != stl.size()) return 0;
+    for(size_t i = 0; i < stl.size(); i++)
+        if(q[i] != stl[i]) return 0;
+    return 1;
+}
+void test1(){
+    printf("test1: iterator arithmetic           ");
+    q.clear(); stl.clear();
+    for(int i = 0; i < 100000; i++){
+        if(i % 3) q.push_back(i), stl.push_back(i);
+        else q.push_front(i), stl.push_front(i);
+    }
+    for(int i = 0; i < 10000; i++){
+        long a = rand() % (q.size() + 1), b = rand() % (q.size() + 1);
+        Deque::iterator x = q.begin() + a, y = b + q.begin();
+        if(y - x != b - a) {puts("Wrong Answer");return;}
+        if((x < y) != (a < b) || (x <= y) != (a <= b) || (x > y) != (a > b) || (x >= y) != (a >= b))
+            {puts("Wrong Answer");return;}
+        if(b < (long)q.size() && x[b - a] != stl[b]) {puts("Wrong Answer");return;}
+        x += b - a;
+        if(x != y) {puts("Wrong Answer");return;}
+        x -= b - a;
+        if(x - q.begin() != a) {puts("Wrong Answer");return;}
+        Deque::const_iterator cx = q.cbegin() + a;
+        if(cx - q.cbegin() != a || (a < (long)q.size() && *cx != stl[a])) {puts("Wrong Answer");return;}
+    }
+    puts("Accept");
+}
+void test2(){
+    printf("test2: std algorithms                ");
+    q.clear(); stl.clear();
+    for(int i = 0; i < N; i++){
+        int v = rand();
+        q.push_back(v); stl.push_back(v);
+    }
+    std::sort(q.begin(), q.end());
+    std::sort(stl.begin(), stl.end());
+    if(!equal()) {puts("Wrong Answer");return;}
+    for(int i = 0; i < 1000; i++){
+        int v = rand();
+        if(std::lower_bound(q.begin(), q.end(), v) - q.begin() != std::lower_bound(stl.begin(), stl.end(), v) - stl.begin())
+            {puts("Wrong Answer");return;}
+    }
+    std::reverse(q.begin(), q.end());
+    std::nth_element(q.begin(), q.begin() + N / 3, q.end());
+    if(q[N / 3] != stl[N / 3]) {puts("Wrong Answer");return;}
+    if(std::distance(q.cbegin(), q.cend()) != N) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test3(){
+    printf("test3: complexity                    ");
+    std::mt19937 gen(rand());
+    for(int k = 0; k < 5; k++){
+        std::shuffle(q.begin(), q.end(), gen);
+        std::sort(q.begin(), q.end());
+    }
+    if(!equal()) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test4(){
+    printf("test4: segmented algorithms          ");
+    q.clear(); stl.clear();
+    for(int i = 0; i < N; i++){
+        int v = rand() % 1000;
+        if(i % 4) q.push_back(v), stl.push_back(v);
+        else q.push_front(v), stl.push_front(v);
+    }
+    for(int k = 0; k < 200; k++){
+        size_t a = rand() % (N + 1), b = rand() % (N + 1);
+        if(a > b) std::swap(a, b);
+        if(k % 2) b = a + (b - a) % 50;
+        Deque::iterator x = q.begin() + a, y = q.begin() + b;
+        int v = rand() % 1000;
+        if(sjtu::find(x, y, v) - q.begin() != std::find(stl.begin() + a, stl.begin() + b, v) - stl.begin())
+            {puts("Wrong Answer");return;}
+        if(sjtu::accumulate(x, y, 0LL) != std::accumulate(stl.begin() + a, stl.begin() + b, 0LL))
+            {puts("Wrong Answer");return;}
+        if(sjtu::count_if(q.cbegin() + a, q.cbegin() + b, [v](int e){return e < v;}) !=
+           std::count_if(stl.begin() + a, stl.begin() + b, [v](int e){return e < v;}))
+            {puts("Wrong Answer");return;}
+        std::vector<int> out(b - a);
+        if(sjtu::copy(x, y, out.begin()) != out.end() || !std::equal(out.begin(), out.end(), stl.begin() + a))
+            {puts("Wrong Answer");return;}
+        sjtu::fill(x, y, v);
+        std::fill(stl.begin() + a, stl.begin() + b, v);
+    }
+    if(!equal()) {puts("Wrong Answer");return;}
+    size_t pieces = 0;
+    sjtu::for_each_segment(q.begin(), q.end(), [&pieces](int *b, int *e){ pieces += e - b; });
+    if(pieces != q.size()) {puts("Wrong Answer");return;}
+    sjtu::deque<char> bytes;
+    for(int i = 0; i < N; i++) bytes.push_front(char('a' + i % 26));
+    for(int k = 0; k < 26; k++){
+        sjtu::deque<char>::iterator hit = sjtu::find(bytes.begin() + k * 7, bytes.end(), char('a' + k));
+        if(hit == bytes.end() || *hit != char('a' + k) || hit - bytes.begin() < k * 7) {puts("Wrong Answer");return;}
+    }
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//iterator arithmetic
+    test2();//std algorithms
+    test3();//complexity
+    test4();//segmented algorithms
+}
@@ -0,0 +1,121 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include "deque.hpp"
+#include "exceptions.hpp"
+
+/***************************/
+int N = 300000;
+/***************************/
+
+typedef sjtu::deque<int> Deque;
+
+bool equal(const Deque &q, const std::deque<int> &stl){
+    if(q.size() != stl.size()) return 0;
+    for(size_t i = 0; i < stl.size(); i++)
+        if(q[i] != stl[i]) return 0;
+    return 1;
+}
+void fill(Deque &q, std::deque<int> &stl, int n){
+    for(int i = 0; i < n; i++){
+        int x = rand();
+        q.push_back(x), stl.push_back(x);
+    }
+}
+bool on(Deque::cursor &c, Deque &q, const std::deque<int> &stl, size_t p){
+    if(c.index() != p) return 0;
+    if(p == stl.size()) return c.at_end() && c.position() == q.end();
+    return *c == stl[p] && size_t(c.position() - q.begin()) == p;
+}
+void test1(){
+    printf("test1: streaming edits               ");
+    Deque q;
+    std::deque<int> stl;
+    fill(q, stl, N);
+    Deque::cursor c = q.cursor_at(N / 2);
+    size_t p = N / 2;
+    for(int k = 0; k < N / 10; k++){
+        int op = rand() % 4, x = rand();
+        if(op == 0){
+            c.insert_before(x);
+            stl.insert(stl.begin() + p, x);
+            p++;
+        }
+        else if(op == 1 && p < stl.size()){
+            c.erase_at();
+            stl.erase(stl.begin() + p);
+        }
+        else if(op == 2){
+            long step = rand() % 9 - 4;
+            if(long(p) + step < 0 || long(p) + step > long(stl.size())) step = 0;
+            c.move_by(step);
+            p += step;
+        }
+        else if(p < stl.size()){
+            *c = x;
+            stl[p] = x;
+        }
+        if(k % 1000 == 0 && !on(c, q, stl, p)) {puts("Wrong Answer");return;}
+    }
+    if(!on(c, q, stl, p) || !equal(q, stl)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test2(){
+    printf("test2: other changes                 ");
+    Deque q;
+    std::deque<int> stl;
+    fill(q, stl, N / 10);
+    Deque::cursor a = q.cursor_at(100), b = q.cursor_at(stl.size());
+    size_t pa = 100, pb = stl.size();
+    for(int k = 0; k < N / 10; k++){
+        int op = rand() % 5, x = rand();
+        if(op == 0) q.push_front(x), stl.push_front(x), pa++, pb++;
+        else if(op == 1) q.push_back(x), stl.push_back(x);
+        else if(op == 2 && pa > 0 && stl.size() > 1) q.pop_front(), stl.pop_front(), pa--, pb--;
+        else if(op == 3){
+            a.insert_before(x);
+            stl.insert(stl.begin() + pa, x);
+            pa++;
+        }
+        else{
+            size_t pos = rand() % (stl.size() + 1);
+            q.insert(q.begin() + pos, x), stl.insert(stl.begin() + pos, x);
+        }
+        if(pb > stl.size()) pb = stl.size();
+        if(!on(a, q, stl, pa) || !on(b, q, stl, pb)) {puts("Wrong Answer");return;}
+    }
+    if(!equal(q, stl)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test3(){
+    printf("test3: end and errors                ");
+    Deque q;
+    std::deque<int> stl;
+    Deque::cursor c = q.cursor_at(0);
+    for(int i = 0; i < 1000; i++) c.insert_before(i), stl.push_back(i);
+    if(!on(c, q, stl, 1000) || !equal(q, stl)) {puts("Wrong Answer");return;}
+    int caught = 0;
+    try{ *c; } catch(std::out_of_range &){ caught++; }
+    try{ c.erase_at(); } catch(std::out_of_range &){ caught++; }
+    try{ c.move_by(1); } catch(std::out_of_range &){ caught++; }
+    try{ c.move_to(1001); } catch(std::out_of_range &){ caught++; }
+    try{ q.cursor_at(1001); } catch(std::out_of_range &){ caught++; }
+    if(caught != 5 || !on(c, q, stl, 1000)) {puts("Wrong Answer");return;}
+    c.move_to(0);
+    while(!c.at_end()) c.erase_at();
+    if(!q.empty()) {puts("Wrong Answer");return;}
+    c.insert_before(7);
+    if(q.size() != 1 || q[0] != 7 || !c.at_end()) {puts("Wrong Answer");return;}
+    q.clear();
+    if(c.index() != 0 || !c.at_end()) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//against std::deque, one cursor
+    test2();//two cursors and direct edits
+    test3();//end() cursors and out_of_range
+}
@@ -0,0 +1,98 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <string>
+#include <vector>
+#include "deque.hpp"
+#include "exceptions.hpp"
+
+/***************************/
+int N = 20000;
+/***************************/
+
+typedef sjtu::deque<std::string> Deque;
+typedef std::deque<std::string> Stl;
+
+bool equal(const Deque &q, const Stl &stl){
+    if(q.size() != stl.size()) return 0;
+    for(size_t i = 0; i < stl.size(); i++)
+        if(q[i] != stl[i]) return 0;
+    size_t i = 0;
+    for(Deque::const_iterator it = q.cbegin(); it != q.cend(); ++it, ++i)
+        if(*it != stl[i]) return 0;
+    return i == stl.size();
+}
+void fill(Deque &q, Stl &stl){
+    for(int i = 0; i < N; i++){
+        std::string s = std::to_string(rand());
+        if(i % 3) q.push_back(s), stl.push_back(s);
+        else q.push_front(s), stl.push_front(s);
+    }
+}
+void test1(){
+    printf("test1: deep copy                     ");
+    Deque q; Stl stl;
+    fill(q, stl);
+    Deque c(q);
+    Stl sc(stl);
+    c[0] = "changed"; sc[0] = "changed";
+    c.pop_back(); sc.pop_back();
+    if(!equal(q, stl) || !equal(c, sc)) {puts("Wrong Answer");return;}
+    Deque a;
+    a = c; a = a;
+    if(!equal(a, sc)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test2(){
+    printf("test2: copy-on-write snapshots       ");
+    Deque q; Stl stl;
+    q.set_copy_on_write(true);
+    fill(q, stl);
+    std::vector<Deque> snaps;
+    std::vector<Stl> ref;
+    for(int k = 0; k < 10; k++){
+        snaps.push_back(q); ref.push_back(stl);
+        if(!snaps.back().copy_on_write()) {puts("Wrong Answer");return;}
+        for(int i = 0; i < 500; i++){
+            size_t p = rand() % stl.size();
+            std::string s = std::to_string(rand());
+            switch(rand() % 4){
+                case 0: q[p] = s; stl[p] = s; break;
+                case 1: *(q.begin() + p) += s; stl[p] += s; break;
+                case 2: q.insert(q.begin() + p, s); stl.insert(stl.begin() + p, s); break;
+                case 3: q.erase(q.begin() + p); stl.erase(stl.begin() + p); break;
+            }
+        }
+    }
+    for(size_t k = 0; k < snaps.size(); k++)
+        if(!equal(snaps[k], ref[k])) {puts("Wrong Answer");return;}
+    snaps[3].clear();
+    snaps[4] = snaps[5]; ref[4] = ref[5];
+    snaps[5].push_front("front"); ref[5].push_front("front");
+    if(!equal(snaps[4], ref[4]) || !equal(snaps[5], ref[5])) {puts("Wrong Answer");return;}
+    if(!snaps[3].empty() || !equal(q, stl)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test3(){
+    printf("test3: complexity                    ");
+    Deque q;
+    for(int i = 0; i < 1000000; i++) q.push_back("x");
+    q.set_copy_on_write(true);
+    long long total = 0;
+    for(int k = 0; k < 2000; k++){
+        Deque snap(q);
+        total += snap.size();
+        q[rand() % q.size()] = "y";
+    }
+    if(total != 2000000000LL) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//deep copy
+    test2();//copy-on-write snapshots
+    test3();//complexity
+}
@@ -0,0 +1,103 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <vector>
+#include "deque.hpp"
+#include "exceptions.hpp"
+
+/***************************/
+int N = 300000;
+/***************************/
+
+typedef sjtu::deque<int> Deque;
+
+bool equal(const Deque &q, const std::deque<int> &stl){
+    if(q.size() != stl.size()) return 0;
+    for(size_t i = 0; i < stl.size(); i++)
+        if(q[i] != stl[i]) return 0;
+    return 1;
+}
+void fill(Deque &q, std::deque<int> &stl, int n){
+    for(int i = 0; i < n; i++){
+        int x = rand();
+        q.push_back(x), stl.push_back(x);
+    }
+}
+void test1(){
+    printf("test1: hinted insert                 ");
+    Deque q;
+    std::deque<int> stl;
+    fill(q, stl, N);
+    for(int round = 0; round < 20; round++){
+        size_t p = rand() % (stl.size() + 1);
+        Deque::iterator it = q.begin() + p;
+        for(int k = 0; k < 2000; k++){
+            int x = rand();
+            it = q.insert(it, x);
+            stl.insert(stl.begin() + p, x);
+            if(*it != x || size_t(it - q.begin()) != p) {puts("Wrong Answer");return;}
+            if(rand() % 3) ++it, ++p;
+        }
+        // shrink the deque so that blocks are left over from a larger block size
+        while(stl.size() > size_t(N / (round + 2))) q.pop_front(), stl.pop_front();
+    }
+    if(!equal(q, stl)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test2(){
+    printf("test2: hinted erase                  ");
+    Deque q;
+    std::deque<int> stl;
+    fill(q, stl, N);
+    for(int round = 0; round < 40 && !stl.empty(); round++){
+        size_t p = rand() % stl.size();
+        Deque::iterator it = q.begin() + p;
+        for(int k = 0; k < 5000 && p < stl.size(); k++){
+            it = q.erase(it);
+            stl.erase(stl.begin() + p);
+            if(size_t(it - q.begin()) != p) {puts("Wrong Answer");return;}
+            if(p < stl.size() ? *it != stl[p] : it != q.end()) {puts("Wrong Answer");return;}
+            if(rand() % 4 == 0 && p < stl.size()) ++it, ++p;
+        }
+    }
+    if(!equal(q, stl)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test3(){
+    printf("test3: insert_many_at                ");
+    Deque q;
+    std::deque<int> stl;
+    fill(q, stl, N / 10);
+    for(int round = 0; round < 2000; round++){
+        size_t p = rand() % (stl.size() + 1), n = rand() % 50;
+        std::vector<int> v;
+        for(size_t i = 0; i < n; i++) v.push_back(rand());
+        Deque::iterator it = q.insert_many_at(q.begin() + p, v.begin(), v.end());
+        stl.insert(stl.begin() + p, v.begin(), v.end());
+        if(size_t(it - q.begin()) != p || (n && *it != v[0])) {puts("Wrong Answer");return;}
+    }
+    if(!equal(q, stl)) {puts("Wrong Answer");return;}
+    Deque e;
+    Deque::iterator it = e.insert_many_at(e.end(), {1, 2, 3});
+    it = e.insert_many_at(it + 1, {4, 5});
+    if(e.size() != 5 || *it != 4 || e[0] != 1 || e[1] != 4 || e[2] != 5 || e[3] != 2) {puts("Wrong Answer");return;}
+    bool caught = false;
+    try{
+        Deque other;
+        other.push_back(1);
+        e.insert_many_at(other.begin(), {6});
+    } catch(std::out_of_range &){
+        caught = true;
+    }
+    if(!caught || e.size() != 5) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//against std::deque::insert
+    test2();//against std::deque::erase
+    test3();//against std::deque range insert
+}
@@ -0,0 +1,108 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "deque.hpp"
+#include "ws_deque.hpp"
+#include "exceptions.hpp"
+
+// define __BENCH to print the throughput of test3
+// #define __BENCH
+
+/***************************/
+int N = 2000000;
+const int THIEVES = 3;
+/***************************/
+
+void test1(){
+    printf("test1: owner operations              ");
+    sjtu::ws_deque<int> q(4);
+    int out = -1;
+    if(!q.empty() || q.pop_back(out) || q.steal(out) || out != -1) {puts("Wrong Answer");return;}
+    for(int i = 0; i < 1000; i++) q.push_back(i);
+    if(q.size() != 1000 || q.capacity() < 1000) {puts("Wrong Answer");return;}
+    for(int i = 0; i < 10; i++)
+        if(!q.steal(out) || out != i) {puts("Wrong Answer");return;}
+    for(int i = 999; i >= 10; i--)
+        if(!q.pop_back(out) || out != i) {puts("Wrong Answer");return;}
+    if(!q.empty() || q.pop_back(out) || q.steal(out)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+
+// owner pushes 0..n-1, popping one of every three pushes; thieves steal the rest
+template <class Push, class Pop, class Steal>
+bool run(Push push, Pop pop, Steal steal, int n){
+    std::atomic<bool> done(false);
+    std::vector<std::vector<int>> got(THIEVES + 1);
+    std::vector<std::thread> thieves;
+    for(int k = 0; k < THIEVES; k++)
+        thieves.emplace_back([&, k](){
+            int v;
+            while(true){
+                if(steal(v)) got[k].push_back(v);
+                else if(done.load()) { if(!steal(v)) break; got[k].push_back(v); }
+                else std::this_thread::yield();
+            }
+        });
+    int v;
+    for(int i = 0; i < n; i++){
+        push(i);
+        if(i % 3 == 0 && pop(v)) got[THIEVES].push_back(v);
+    }
+    while(pop(v)) got[THIEVES].push_back(v);
+    done.store(true);
+    for(auto &t : thieves) t.join();
+    std::vector<char> seen(n, 0);
+    size_t total = 0;
+    for(auto &g : got)
+        for(int x : g){
+            if(x < 0 || x >= n || seen[x]) return 0;
+            seen[x] = 1;
+            total++;
+        }
+    return total == size_t(n);
+}
+
+void test2(){
+    printf("test2: owner and thieves             ");
+    sjtu::ws_deque<int> q;
+    if(!run([&](int x){ q.push_back(x); }, [&](int &x){ return q.pop_back(x); },
+            [&](int &x){ return q.steal(x); }, N)) {puts("Wrong Answer");return;}
+    if(!q.empty()) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test3(){
+    printf("test3: throughput                    ");
+    typedef std::chrono::steady_clock clock;
+    sjtu::ws_deque<int> ws;
+    clock::time_point start = clock::now();
+    bool ok = run([&](int x){ ws.push_back(x); }, [&](int &x){ return ws.pop_back(x); },
+                  [&](int &x){ return ws.steal(x); }, N);
+    double lock_free = std::chrono::duration<double>(clock::now() - start).count();
+    sjtu::deque<int> dq;
+    std::mutex m;
+    start = clock::now();
+    ok = ok && run([&](int x){ std::lock_guard<std::mutex> g(m); dq.push_back(x); },
+                   [&](int &x){ std::lock_guard<std::mutex> g(m); if(dq.empty()) return false; x = dq.back(); dq.pop_back(); return true; },
+                   [&](int &x){ std::lock_guard<std::mutex> g(m); if(dq.empty()) return false; x = dq.front(); dq.pop_front(); return true; }, N);
+    double locked = std::chrono::duration<double>(clock::now() - start).count();
+    if(!ok) {puts("Wrong Answer");return;}
+#ifdef __BENCH
+    printf("ws_deque %.3fs, mutex + deque %.3fs ", lock_free, locked);
+#else
+    (void)lock_free; (void)locked;
+#endif
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//single thread
+    test2();//every element taken exactly once
+    test3();//against a mutex-wrapped sjtu::deque
+}
@@ -0,0 +1,85 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include <deque>
+#include <string>
+#include "deque.hpp"
+#include "exceptions.hpp"
+
+/***************************/
+int N = 1000000;
+/***************************/
+
+typedef sjtu::deque<int> Deque;
+
+bool equal(const Deque &q, const std::deque<int> &stl){
+    if(q.size() != stl.size()) return 0;
+    for(size_t i = 0; i < stl.size(); i++)
+        if(q[i] != stl[i]) return 0;
+    return 1;
+}
+void test1(){
+    printf("test1: memory_stats                  ");
+    Deque q;
+    sjtu::deque_memory_stats s = q.memory_stats();
+    if(s.blocks || s.element_bytes || s.avg_fill != 0) {puts("Wrong Answer");return;}
+    for(int i = 0; i < N; i++) q.push_back(i);
+    s = q.memory_stats();
+    if(s.element_bytes != N * sizeof(int) || s.bytes_allocated < s.element_bytes) {puts("Wrong Answer");return;}
+    if(!s.blocks || s.min_fill > s.max_fill || s.max_fill > 2 * s.block_size) {puts("Wrong Answer");return;}
+    if(s.avg_fill <= 0 || s.avg_fill > 1 || !s.allocations || !s.resizes) {puts("Wrong Answer");return;}
+    size_t allocations = s.allocations;
+    for(int k = 0; k < 100000; k++) q.push_front(k), q.pop_front();  // served from cached buffers
+    if(q.memory_stats().allocations > allocations + 2) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test2(){
+    printf("test2: rebalance counter             ");
+    Deque q;
+    for(int i = 0; i < N; i++) q.push_back(i);
+    size_t before = q.memory_stats().rebalances;
+    // grow and shrink across a block_size threshold over and over
+    for(int round = 0; round < 6; round++){
+        for(int i = 0; i < N; i++) q.push_back(i);
+        for(int i = 0; i < N; i++) q.pop_back();
+    }
+    sjtu::deque_memory_stats s = q.memory_stats();
+    if(s.rebalances < before || s.resizes < 2) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test3(){
+    printf("test3: shrink_to_fit                 ");
+    Deque q;
+    std::deque<int> stl;
+    for(int i = 0; i < N; i++) q.push_back(i), stl.push_back(i);
+    for(int i = 0; i < N / 100; i++){  // thin every block out, leaving a sparse chain
+        size_t p = rand() % q.size(), len = std::min(q.size() - p, (size_t)90);
+        q.erase(q.begin() + p, q.begin() + p + len);
+        stl.erase(stl.begin() + p, stl.begin() + p + len);
+    }
+    sjtu::deque_memory_stats before = q.memory_stats();
+    q.shrink_to_fit();
+    sjtu::deque_memory_stats after = q.memory_stats();
+    if(!equal(q, stl)) {puts("Wrong Answer");return;}
+    if(after.bytes_allocated > before.bytes_allocated || after.blocks > before.blocks || after.avg_fill < 0.5)
+        {puts("Wrong Answer");return;}
+    for(int i = 0; i < 1000; i++){
+        size_t p = rand() % (q.size() + 1);
+        q.insert(q.begin() + p, i); stl.insert(stl.begin() + p, i);
+    }
+    if(!equal(q, stl)) {puts("Wrong Answer");return;}
+    sjtu::deque<std::string> s(1000, "abc");
+    s.erase(s.begin() + 10, s.end() - 10);
+    s.shrink_to_fit();
+    if(s.size() != 20 || s[19] != "abc" || s.memory_stats().blocks > 2) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//fields are consistent
+    test2();//block_size changes are counted
+    test3();//compaction keeps the contents
+}
@@ -1,5 +1,6 @@
 #include "deque.hpp"
 
+#include <chrono>
 #include <ctime>
 #include <iostream>
 #include <deque>
@@ -7,6 +8,9 @@
 #include <string>
 #include <vector>
 #include <ctime>
+#include <cstdlib>
+#include <memory>
+#include <new>
 
 //std::default_random_engine randnum(time(NULL));
 
@@ -62,25 +66,44 @@ public:
     bool operator != (const DynamicType &rhs) const { return false; }
 };
 
+// wall-clock time; clock() counts CPU time of every thread and hides time spent blocked
 class Timer{
 private:
-    long dfnStart, dfnEnd;
+    std::chrono::steady_clock::time_point dfnStart, dfnEnd;
 
 public:
     void init() {
-        dfnEnd = dfnStart = clock();
+        dfnEnd = dfnStart = std::chrono::steady_clock::now();
     }
     void stop() {
-        dfnEnd = clock();
+        dfnEnd = std::chrono::steady_clock::now();
     }
     double getTime() {
-        return 1.0 * (dfnEnd - dfnStart) / CLOCKS_PER_SEC;
+        return std::chrono::duration<double>(dfnEnd - dfnStart).count();
     }
 
 };
 
 Timer timer;
 
+// live heap bytes, for the node storage benchmark in Test Zone C
+static long long liveBytes = 0;
+
+void *operator new(size_t size) {
+    void *p = malloc(size + 16);
+    if (!p) throw std::bad_alloc();
+    *(size_t *)p = size;
+    liveBytes += size;
+    return (char *)p + 16;
+}
+void operator delete(void *p) noexcept {
+    if (!p) return;
+    p = (char *)p - 16;
+    liveBytes -= *(size_t *)p;
+    free(p);
+}
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+
 bool isEqual(std::deque<Int> &a, sjtu::deque<Int> &b) {
     static std::vector<Int> resultA, resultB;
     resultA.clear();
@@ -1497,8 +1520,141 @@ static CheckerPair TEST_B[] = {
     std::make_pair("Equal Operator", equalOperatorTimer),
 };
 
+// the previous double_list node layout: one Node plus one shared_ptr control block per element
+template <class T>
+class SharedNodeList {
+    struct Node {
+        std::shared_ptr<T> data;
+        Node *pre, *nxt;
+    };
+    Node *head = nullptr, *tail = nullptr;
+
+public:
+    ~SharedNodeList() {
+        while (head) {
+            Node *tmp = head;
+            head = head->nxt;
+            delete tmp;
+        }
+    }
+    void insert_tail(const T &value) {
+        Node *node = new Node{std::make_shared<T>(value), tail, nullptr};
+        if (tail) tail->nxt = node;
+        else head = node;
+        tail = node;
+    }
+    size_t traverse() {
+        size_t cnt = 0;
+        for (Node *node = head; node; node = node->nxt) cnt += (node->data != nullptr);
+        return cnt;
+    }
+};
+
+template <class T>
+size_t traverse(SharedNodeList<T> &list) { return list.traverse(); }
+template <class T>
+size_t traverse(sjtu::double_list<T> &list) {
+    size_t cnt = 0;
+    for (auto it = list.begin(); it != list.end(); ++it) cnt += (&*it != nullptr);
+    return cnt;
+}
+
+static double bytesPerElement = 0;
+static int nodeBenchCounter = 0;
+
+template <class List, class Make>
+std::pair<bool, double> nodeStorageTimer(Make make) {
+    bool ok;
+    nodeBenchCounter = 0;
+    timer.init();
+    {
+        long long before = liveBytes;
+        List list;
+        for (int i = 0; i < N_SPEED; i++) {
+            list.insert_tail(make(i));
+        }
+        bytesPerElement = 1.0 * (liveBytes - before) / N_SPEED;
+        ok = traverse(list) == (size_t)N_SPEED;
+    }
+    timer.stop();
+    return std::make_pair(ok && nodeBenchCounter == 0, timer.getTime());
+}
+
+Int makeInt(int i) { return Int(i); }
+DynamicType makeDynamic(int) { return DynamicType(&nodeBenchCounter); }
+
+std::pair<bool, double> inlineIntTimer() { return nodeStorageTimer<sjtu::double_list<Int>>(makeInt); }
+std::pair<bool, double> sharedIntTimer() { return nodeStorageTimer<SharedNodeList<Int>>(makeInt); }
+std::pair<bool, double> inlineDynamicTimer() { return nodeStorageTimer<sjtu::double_list<DynamicType>>(makeDynamic); }
+std::pair<bool, double> sharedDynamicTimer() { return nodeStorageTimer<SharedNodeList<DynamicType>>(makeDynamic); }
+
+static CheckerPair TEST_C[] = {
+    std::make_pair("double_list<Int>, inline node", inlineIntTimer),
+    std::make_pair("double_list<Int>, shared_ptr node", sharedIntTimer),
+    std::make_pair("double_list<DynamicType>, inline node", inlineDynamicTimer),
+    std::make_pair("double_list<DynamicType>, shared_ptr node", sharedDynamicTimer),
+};
+
+// 4- and 16-byte payloads, each once trivially copyable and once with a
+// user-provided copy constructor, which keeps the deque on its element-wise path
+struct Quad {
+    int a, b, c, d;
+    Quad() = default;
+    Quad(int x) : a(x), b(x + 1), c(x + 2), d(x + 3) {}
+    bool operator==(const Quad &rhs) const { return a == rhs.a && b == rhs.b && c == rhs.c && d == rhs.d; }
+    bool operator!=(const Quad &rhs) const { return !(*this == rhs); }
+};
+template <class Base>
+struct Boxed : Base {
+    Boxed() = default;
+    Boxed(int x) : Base(x) {}
+    Boxed(const Boxed &other) : Base(other) {}
+    Boxed &operator=(const Boxed &other) { Base::operator=(other); return *this; }
+};
+
+template <class T>
+std::pair<bool, double> blockKernelTimer() {
+    std::deque<T> a;
+    sjtu::deque<T> b;
+    for (int i = 0; i < N_SPEED * 10; i++) {
+        a.push_back(T(i));
+        b.push_back(T(i));
+    }
+    std::vector<size_t> pos;
+    for (int i = 0; i < N_SPEED * 2; i++) {
+        pos.push_back(rand() % (b.size() + 1));
+        pos.push_back(rand() % b.size());
+    }
+    timer.init();
+    for (size_t i = 0; i < pos.size(); i += 2) {
+        b.insert(b.begin() + pos[i], T(i));
+        b.erase(b.begin() + pos[i + 1]);
+    }
+    bool ok = true;
+    for (int k = 0; k < 20; k++) {
+        sjtu::deque<T> c(b);
+        ok = ok && c.size() == b.size();
+    }
+    timer.stop();
+    for (size_t i = 0; i < pos.size(); i += 2) {
+        a.insert(a.begin() + pos[i], T(i));
+        a.erase(a.begin() + pos[i + 1]);
+    }
+    for (size_t i = 0; ok && i < a.size(); i++) ok = a[i] == b[i];
+    return std::make_pair(ok, timer.getTime());
+}
+
+static CheckerPair TEST_D[] = {
+    std::make_pair("insert/erase/copy, 4-byte trivially copyable", blockKernelTimer<Int>),
+    std::make_pair("insert/erase/copy, 4-byte with copy constructor", blockKernelTimer<Boxed<Int>>),
+    std::make_pair("insert/erase/copy, 16-byte trivially copyable", blockKernelTimer<Quad>),
+    std::make_pair("insert/erase/copy, 16-byte with copy constructor", blockKernelTimer<Boxed<Quad>>),
+};
+
 #define __CORRECT_TEST
 #define __SPEED_TEST
+#define __NODE_TEST
+#define __KERNEL_TEST
 #define __OFFICAL
 
 int main() {
@@ -1562,5 +1718,48 @@ int main() {
     }
     puts("---------------------------------------------------------------------------");
 #endif
+
+#ifdef __NODE_TEST
+    puts("");
+    puts("---------------------------------------------------------------------------");
+    try{
+        puts("Test Zone C: Node storage Testing...");
+        printf("Test Size: %d Element(s)\n", N_SPEED);
+        int n = sizeof(TEST_C) / sizeof(CheckerPair);
+        for (int i = 0; i < n; i++) {
+            printf("Test %d: %-59s", i + 1, TEST_C[i].first);
+            std::pair<bool, double> result = TEST_C[i].second();
+#ifndef __OFFICAL
+            printf("%.4f (%.1f bytes/element)\n", result.second, bytesPerElement);
+#else
+            puts(result.first ? "PASSED" : "FAILED");
+#endif
+        }
+    } catch(...) {
+        puts("Unknown Error Occured");
+    }
+    puts("---------------------------------------------------------------------------");
+#endif
+#ifdef __KERNEL_TEST
+    puts("");
+    puts("---------------------------------------------------------------------------");
+    try{
+        puts("Test Zone D: Block kernel Testing...");
+        printf("Test Size: %d Element(s)\n", N_SPEED * 10);
+        int n = sizeof(TEST_D) / sizeof(CheckerPair);
+        for (int i = 0; i < n; i++) {
+            printf("Test %d: %-59s", i + 1, TEST_D[i].first);
+            std::pair<bool, double> result = TEST_D[i].second();
+#ifndef __OFFICAL
+            printf("%.4f\n", result.second);
+#else
+            puts(result.first ? "PASSED" : "FAILED");
+#endif
+        }
+    } catch(...) {
+        puts("Unknown Error Occured");
+    }
+    puts("---------------------------------------------------------------------------");
+#endif
     return 0;
 }
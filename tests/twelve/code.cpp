@@ -0,0 +1,139 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "deque.hpp"
+#include "deque_parallel.hpp"
+#include "exceptions.hpp"
+
+// define __BENCH to time each algorithm over 10^7 elements with 1 to N threads
+// #define __BENCH
+
+/***************************/
+int N = 1000000;
+/***************************/
+
+typedef sjtu::deque<long long> Deque;
+
+Deque q;
+std::deque<long long> stl;
+bool equal(){
+    if(q.size() != stl.size()) return 0;
+    for(size_t i = 0; i < stl.size(); i++)
+        if(q[i] != stl[i]) return 0;
+    return 1;
+}
+void fill(int n){
+    q.clear(); stl.clear();
+    for(int i = 0; i < n; i++){
+        long long x = rand();
+        if(i % 3) q.push_back(x), stl.push_back(x);
+        else q.push_front(x), stl.push_front(x);
+    }
+}
+void test1(){
+    printf("test1: for_each / transform          ");
+    for(size_t threads = 1; threads <= 4; threads++){
+        sjtu::parallel::set_thread_count(threads);
+        fill(N);
+        sjtu::parallel::for_each(q.begin(), q.end(), [](long long &x){ x = x * 3 + 1; });
+        std::for_each(stl.begin(), stl.end(), [](long long &x){ x = x * 3 + 1; });
+        if(!equal()) {puts("Wrong Answer");return;}
+        Deque out(q.size(), 0);
+        if(sjtu::parallel::transform(q.cbegin(), q.cend(), out.begin(), [](long long x){ return -x; }) != out.end())
+            {puts("Wrong Answer");return;}
+        for(size_t i = 0; i < stl.size(); i++) if(out[i] != -stl[i]) {puts("Wrong Answer");return;}
+        std::vector<long long> v(stl.begin(), stl.end()), w(v.size());
+        sjtu::parallel::transform(v.begin(), v.end(), w.begin(), [](long long x){ return x % 7; });
+        for(size_t i = 0; i < v.size(); i++) if(w[i] != v[i] % 7) {puts("Wrong Answer");return;}
+    }
+    puts("Accept");
+}
+void test2(){
+    printf("test2: reduce                        ");
+    for(size_t threads = 1; threads <= 4; threads++){
+        sjtu::parallel::set_thread_count(threads);
+        fill(N);
+        if(sjtu::parallel::reduce(q.cbegin(), q.cend(), 5LL) != std::accumulate(stl.begin(), stl.end(), 5LL))
+            {puts("Wrong Answer");return;}
+        if(sjtu::parallel::reduce(q.begin(), q.begin(), 7LL) != 7) {puts("Wrong Answer");return;}
+        long long mx = sjtu::parallel::reduce(q.begin() + 1, q.end(), q[0], [](long long a, long long b){ return std::max(a, b); });
+        if(mx != *std::max_element(stl.begin(), stl.end())) {puts("Wrong Answer");return;}
+    }
+    puts("Accept");
+}
+void test3(){
+    printf("test3: sort                          ");
+    for(size_t threads = 1; threads <= 5; threads++){
+        sjtu::parallel::set_thread_count(threads);
+        fill(N + threads);
+        sjtu::parallel::sort(q);
+        std::sort(stl.begin(), stl.end());
+        if(!equal()) {puts("Wrong Answer");return;}
+        sjtu::parallel::sort(q.begin() + 10, q.end() - 10, std::greater<long long>());
+        if(!std::is_sorted(q.begin() + 10, q.end() - 10, std::greater<long long>())) {puts("Wrong Answer");return;}
+    }
+    puts("Accept");
+}
+void test4(){
+    printf("test4: exceptions                    ");
+    sjtu::parallel::set_thread_count(4);
+    fill(N);
+    long long target = q[N / 2];
+    bool caught = false;
+    try{
+        sjtu::parallel::for_each(q, [target](long long x){ if(x == target) throw std::runtime_error("found"); });
+    } catch(std::runtime_error &){
+        caught = true;
+    }
+    // a parallel call from inside a task runs inline on that thread
+    std::vector<long long> sums(16);
+    sjtu::parallel::for_each(sums.begin(), sums.end(), [](long long &s){
+        s = sjtu::parallel::reduce(q.cbegin(), q.cbegin() + 1000, 0LL);
+    });
+    for(long long s : sums) if(s != std::accumulate(stl.begin(), stl.begin() + 1000, 0LL)) {puts("Wrong Answer");return;}
+    if(!caught) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+#ifdef __BENCH
+void bench(){
+    typedef std::chrono::steady_clock clock;
+    size_t hw = std::max(4u, std::thread::hardware_concurrency());
+    fill(N * 10);
+    for(size_t threads = 1; threads <= hw; threads *= 2){
+        sjtu::parallel::set_thread_count(threads);
+        Deque d(q), out(q.size(), 0);
+        clock::time_point t0 = clock::now();
+        sjtu::parallel::for_each(d, [](long long &x){ x = x * x % 1000003; });
+        clock::time_point t1 = clock::now();
+        sjtu::parallel::transform(d.cbegin(), d.cend(), out.begin(), [](long long x){ return x * 7 + 3; });
+        clock::time_point t2 = clock::now();
+        volatile long long s = sjtu::parallel::reduce(out.cbegin(), out.cend(), 0LL);
+        (void)s;
+        clock::time_point t3 = clock::now();
+        sjtu::parallel::sort(d);
+        clock::time_point t4 = clock::now();
+        printf("threads %2zu: for_each %.3f transform %.3f reduce %.3f sort %.3f\n", threads,
+               std::chrono::duration<double>(t1 - t0).count(), std::chrono::duration<double>(t2 - t1).count(),
+               std::chrono::duration<double>(t3 - t2).count(), std::chrono::duration<double>(t4 - t3).count());
+    }
+}
+#endif
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//against std::for_each / std::transform
+    test2();//against std::accumulate
+    test3();//against std::sort
+    test4();//exceptions and nested calls
+#ifdef __BENCH
+    bench();//scaling
+#endif
+}
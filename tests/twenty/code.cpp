@@ -0,0 +1,186 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <new>
+#include <string>
+#include <vector>
+#include "small_deque.hpp"
+#include "exceptions.hpp"
+
+/***************************/
+int N = 200000;
+/***************************/
+
+// operator new calls so far
+static long long allocations = 0;
+
+void *operator new(size_t size) {
+    ++allocations;
+    void *p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void *operator new[](size_t size) { return operator new(size); }
+// every delete ends here; kept out of line so that GCC, seeing free() inlined next to a
+// call of operator new, does not report a mismatched pair
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { operator delete(p); }
+void operator delete[](void *p) noexcept { operator delete(p); }
+void operator delete[](void *p, size_t) noexcept { operator delete(p); }
+
+typedef sjtu::small_deque<int, 8> Small;
+
+template<class Q, class S>
+bool equal(const Q &q, const S &stl){
+    if(q.size() != stl.size()) return 0;
+    for(size_t i = 0; i < stl.size(); i++)
+        if(!(q[i] == stl[i])) return 0;
+    typename Q::const_iterator it = q.cbegin();
+    for(size_t i = 0; i < stl.size(); i++, ++it)
+        if(!(*it == stl[i])) return 0;
+    return it == q.cend() && q.cend() - q.cbegin() == (long)stl.size();
+}
+void test1(){
+    printf("test1: across the spill boundary     ");
+    Small q;
+    std::deque<int> stl;
+    for(int i = 0; i < N; i++){
+        int x = rand(), op = rand() % 7;
+        size_t limit = (i / 2000) % 2 ? 40 : 10;  // phases that stay near N and that spill
+        if(stl.size() > limit) op = 4 + op % 3;
+        if(op == 0) q.push_back(x), stl.push_back(x);
+        else if(op == 1) q.push_front(x), stl.push_front(x);
+        else if(op == 2 || op == 3){
+            size_t p = rand() % (stl.size() + 1);
+            Small::iterator it = q.insert(q.begin() + p, x);
+            stl.insert(stl.begin() + p, x);
+            if(*it != x || size_t(it - q.begin()) != p) {puts("Wrong Answer");return;}
+        }
+        else if(stl.empty()) continue;
+        else if(op == 4) q.pop_back(), stl.pop_back();
+        else if(op == 5) q.pop_front(), stl.pop_front();
+        else{
+            size_t p = rand() % stl.size();
+            Small::iterator it = q.erase(q.begin() + p);
+            stl.erase(stl.begin() + p);
+            if(p < stl.size() ? *it != stl[p] : it != q.end()) {puts("Wrong Answer");return;}
+        }
+        if(!q.spilled() && q.size() > 8) {puts("Wrong Answer");return;}
+        if(stl.empty() && q.spilled()) {puts("Wrong Answer");return;}
+        if(i % 97 == 0 && !equal(q, stl)) {puts("Wrong Answer");return;}
+        if(i % 1009 == 0){
+            q.shrink_to_fit();
+            if(q.spilled() != (stl.size() > 8) || !equal(q, stl)) {puts("Wrong Answer");return;}
+        }
+    }
+    if(!equal(q, stl)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+// fills, edits, copies, moves and swaps a, the same way for every container type
+template<class Q>
+void churn(Q &a, const std::vector<int> &xs){
+    size_t k = 0;
+    for(int round = 0; round < 1000; round++){
+        while(a.size() < 16){
+            int x = xs[k++];
+            if(x % 2) a.push_back(x);
+            else a.push_front(x);
+        }
+        a.erase(a.begin() + 5);
+        a.insert(a.begin() + 9, round);
+        Q b;
+        b = a;
+        Q c(std::move(b));
+        c.swap(a);
+        for(int i = 0; i < 7; i++) a.pop_front();
+    }
+}
+void test2(){
+    printf("test2: no allocation while inline    ");
+    if(sizeof(sjtu::small_deque<int, 16>) != 16 * sizeof(int) + 3 * sizeof(size_t)) {puts("Wrong Answer");return;}
+    std::vector<int> xs(16000);
+    for(size_t i = 0; i < xs.size(); i++) xs[i] = rand();
+    sjtu::small_deque<int, 16> a;
+    std::deque<int> sa;
+    long long before = allocations;
+    churn(a, xs);
+    while(a.size() < 16) a.push_back(1);
+    if(allocations != before || a.spilled()) {puts("Wrong Answer");return;}
+    a.push_front(2);  // the 17th element
+    if(!a.spilled() || allocations == before) {puts("Wrong Answer");return;}
+    churn(sa, xs);
+    while(sa.size() < 16) sa.push_back(1);
+    sa.push_front(2);
+    if(!equal(a, sa)) {puts("Wrong Answer");return;}
+    long long spilled = allocations;
+    sjtu::small_deque<int, 16> d(std::move(a));  // moves the pointer
+    if(allocations != spilled || a.spilled() || !a.empty() || !equal(d, sa)) {puts("Wrong Answer");return;}
+    while(!d.empty()) d.pop_back();
+    if(d.spilled()) {puts("Wrong Answer");return;}
+    bool caught = false;
+    try{ d.pop_front(); } catch(std::out_of_range &){ caught = true; }
+    if(!caught) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+
+int live = 0;
+class Counted {
+public:
+    std::string s;
+    Counted(const std::string &s) : s(s) { live++; }
+    Counted(const Counted &other) : s(other.s) { live++; }
+    Counted(Counted &&other) noexcept : s(std::move(other.s)) { live++; }
+    Counted &operator=(const Counted &) = default;
+    Counted &operator=(Counted &&) = default;
+    ~Counted() { live--; }
+    bool operator==(const Counted &rhs) const { return s == rhs.s; }
+};
+void test3(){
+    printf("test3: non-trivial elements          ");
+    {
+        typedef sjtu::small_deque<Counted, 4> Q;
+        std::deque<Counted> stl;
+        Q q;
+        for(int i = 0; i < N / 20; i++){
+            Counted x(std::to_string(rand()));
+            int op = rand() % 6;
+            if(stl.size() > 12) op = 3;
+            if(op == 0) q.push_back(x), stl.push_back(x);
+            else if(op == 1) q.emplace_front(x.s), stl.push_front(x);
+            else if(op == 2){
+                size_t p = rand() % (stl.size() + 1);
+                q.insert(q.begin() + p, x), stl.insert(stl.begin() + p, x);
+            }
+            else if(stl.empty()) continue;
+            else if(op == 3){
+                size_t p = rand() % stl.size();
+                q.erase(q.begin() + p), stl.erase(stl.begin() + p);
+            }
+            else if(op == 4) q.pop_back(), stl.pop_back();
+            else q.push_back(q.front()), stl.push_back(stl.front());  // may spill while referring to an element
+            if(i % 50 == 0){
+                Q copy(q), moved;
+                moved = std::move(copy);
+                if(!equal(moved, stl)) {puts("Wrong Answer");return;}
+                Q other(3, x);
+                other.swap(moved);
+                if(!equal(other, stl) || moved.size() != 3 || !(moved.back() == x)) {puts("Wrong Answer");return;}
+            }
+        }
+        if(!equal(q, stl)) {puts("Wrong Answer");return;}
+    }
+    if(live != 0) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//against std::deque
+    test2();//operator new calls, sizeof and moves
+    test3();//copies, moves and swaps of strings
+}
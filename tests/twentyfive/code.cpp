@@ -0,0 +1,86 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iterator>
+#include <list>
+#include "deque.hpp"
+#include "exceptions.hpp"
+
+/***************************/
+int N = 100000;
+/***************************/
+
+// walks forward and backward with a step limit, so that a cycle fails instead of hanging
+template<class L>
+bool same(L &list, const std::list<int> &stl){
+    if(list.size() != stl.size()) return 0;
+    size_t steps = 0;
+    std::list<int>::const_iterator s = stl.begin();
+    for(typename L::iterator it = list.begin(); it != list.end(); ++it, ++s)
+        if(++steps > stl.size() || *it != *s) return 0;
+    if(steps != stl.size()) return 0;
+    if(stl.empty()) return list.get_tail() == list.end();
+    steps = 0;
+    std::list<int>::const_reverse_iterator r = stl.rbegin();
+    for(typename L::iterator it = list.get_tail(); ; --it, ++r){
+        if(++steps > stl.size() || *it != *r) return 0;
+        if(it == list.begin()) break;
+    }
+    return steps == stl.size();
+}
+template<class L>
+typename L::iterator advance(L &list, size_t n){
+    typename L::iterator it = list.begin();
+    while(n--) ++it;
+    return it;
+}
+void test1(){
+    printf("test1: splice within one list        ");
+    sjtu::double_list<int> list;
+    std::list<int> stl;
+    for(int i = 0; i < 200; i++) list.insert_tail(i), stl.push_back(i);
+    // pos on the moved node, or on the range's first node, changes nothing
+    for(size_t p = 0; p < 200; p += 37){
+        list.splice(advance(list, p), list, advance(list, p));
+        list.splice(advance(list, p), list, advance(list, p), advance(list, p + 3), 3);
+        list.splice(advance(list, p + 3), list, advance(list, p), advance(list, p + 3), 3);
+    }
+    if(!same(list, stl)) {puts("Wrong Answer");return;}
+    for(int i = 0; i < N; i++){
+        size_t n = stl.size();
+        size_t a = rand() % n, b = a + rand() % (n - a + 1);
+        // pos outside (a, b)
+        size_t p = rand() % 2 ? rand() % (a + 1) : b + rand() % (n - b + 1);
+        list.splice(advance(list, p), list, advance(list, a), advance(list, b), b - a);
+        if(p != a) stl.splice(std::next(stl.begin(), p), stl, std::next(stl.begin(), a), std::next(stl.begin(), b));
+        if(i % 1000 == 0 && !same(list, stl)) {puts("Wrong Answer");return;}
+    }
+    if(!same(list, stl)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test2(){
+    printf("test2: splice between lists          ");
+    sjtu::double_list<int> a, b;
+    std::list<int> sa, sb;
+    for(int i = 0; i < 100; i++) a.insert_tail(i), sa.push_back(i), b.insert_tail(-i), sb.push_back(-i);
+    for(int i = 0; i < N / 10; i++){
+        sjtu::double_list<int> &from = i % 2 ? a : b, &to = i % 2 ? b : a;
+        std::list<int> &sfrom = i % 2 ? sa : sb, &sto = i % 2 ? sb : sa;
+        if(sfrom.empty()) continue;
+        size_t x = rand() % sfrom.size(), y = x + rand() % (sfrom.size() - x + 1), p = rand() % (sto.size() + 1);
+        to.splice(advance(to, p), from, advance(from, x), advance(from, y), y - x);
+        sto.splice(std::next(sto.begin(), p), sfrom, std::next(sfrom.begin(), x), std::next(sfrom.begin(), y));
+        if(i % 100 == 0 && !(same(a, sa) && same(b, sb))) {puts("Wrong Answer");return;}
+    }
+    b.splice(b.begin(), a);
+    sb.splice(sb.begin(), sa);
+    if(!same(a, sa) || !same(b, sb)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//O(1) relinks, including the position on the moved range itself
+    test2();//ranges and whole lists from another list
+}
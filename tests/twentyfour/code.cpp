@@ -0,0 +1,256 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <iterator>
+#include <list>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "deque.hpp"
+#include "exceptions.hpp"
+
+/***************************/
+int N = 20000;
+/***************************/
+
+template<class Q, class S>
+bool equal(Q &q, const S &stl){
+    if(q.size() != stl.size()) return 0;
+    for(size_t i = 0; i < stl.size(); i++)
+        if(!(q[i] == stl[i])) return 0;
+    typename Q::iterator it = q.begin();
+    for(size_t i = 0; i < stl.size(); i++, ++it)
+        if(!(*it == stl[i])) return 0;
+    return it == q.end();
+}
+
+// random batches at both ends, through pointers (memcpy) and through list iterators / back_inserter
+template<class Q>
+bool batches(Q &q, std::deque<int> &stl, int n){
+    for(int i = 0; i < n; i++){
+        int op = rand() % 9;
+        size_t count = rand() % 3 ? rand() % 50 : rand() % 3000;
+        std::vector<int> v(count);
+        for(size_t k = 0; k < count; k++) v[k] = rand();
+        if(op == 0){
+            q.push_back_n(v.data(), count);
+            stl.insert(stl.end(), v.begin(), v.end());
+        }
+        else if(op == 1){
+            q.push_front_n(static_cast<const int *>(v.data()), count);
+            stl.insert(stl.begin(), v.begin(), v.end());
+        }
+        else if(op == 2){
+            std::list<int> l(v.begin(), v.end());
+            if(rand() % 2) q.push_back_n(l.begin(), count), stl.insert(stl.end(), v.begin(), v.end());
+            else q.push_front_n(l.begin(), count), stl.insert(stl.begin(), v.begin(), v.end());
+        }
+        else if(op == 3 || op == 4){
+            count = count < stl.size() ? count : stl.size();
+            std::vector<int> got(count);
+            bool front = op == 3;
+            int *end = front ? q.pop_front_n(count, got.data()) : q.pop_back_n(count, got.data());
+            if(end != got.data() + count) return 0;
+            std::deque<int>::iterator from = front ? stl.begin() : stl.end() - count;
+            if(!std::equal(got.begin(), got.end(), from)) return 0;
+            stl.erase(from, from + count);
+        }
+        else if(op == 5){
+            count = count < stl.size() ? count : stl.size();
+            std::vector<int> got;
+            if(rand() % 2){
+                q.pop_front_n(count, std::back_inserter(got));
+                if(!std::equal(got.begin(), got.end(), stl.begin())) return 0;
+                stl.erase(stl.begin(), stl.begin() + count);
+            } else {
+                q.pop_back_n(count);
+                stl.erase(stl.end() - count, stl.end());
+            }
+        }
+        else if(op == 6){
+            int x = rand();
+            if(rand() % 2) q.push_front(x), stl.push_front(x);
+            else q.push_back(x), stl.push_back(x);
+            if(!stl.empty()){
+                size_t p = rand() % stl.size();
+                q.insert(q.begin() + p, x), stl.insert(stl.begin() + p, x);
+            }
+        }
+        else if(op == 7 && !stl.empty()){
+            q.pop_front(), stl.pop_front();
+            if(!stl.empty()) q.pop_back(), stl.pop_back();
+        }
+        else if(op == 8 && stl.size() > 100){
+            size_t p = rand() % (stl.size() - 100);
+            q.erase(q.begin() + p, q.begin() + p + 100), stl.erase(stl.begin() + p, stl.begin() + p + 100);
+        }
+        if(!stl.empty()){
+            size_t p = rand() % stl.size();
+            if(q[p] != stl[p] || q.front() != stl.front() || q.back() != stl.back()) return 0;
+        }
+        if(i % 997 == 0 && !equal(q, stl)) return 0;
+    }
+    std::vector<int> rest;
+    q.drain_into(std::back_inserter(rest));
+    if(!q.empty() || rest.size() != stl.size() || !std::equal(rest.begin(), rest.end(), stl.begin())) return 0;
+    stl.clear();
+    return 1;
+}
+void test1(){
+    printf("test1: batches against std::deque    ");
+    sjtu::deque<int> q;
+    std::deque<int> stl;
+    if(!batches(q, stl, N)) {puts("Wrong Answer");return;}
+    // an empty deque takes batches again, and keeps taking single pushes
+    if(!batches(q, stl, N / 4)) {puts("Wrong Answer");return;}
+    bool caught = false;
+    q.push_back(1);
+    int sink[4];
+    try{ q.pop_front_n(2, sink); } catch(std::out_of_range &){ caught = true; }
+    if(!caught || q.size() != 1) {puts("Wrong Answer");return;}
+    caught = false;
+    try{ q.pop_back_n(5); } catch(std::out_of_range &){ caught = true; }
+    if(!caught || q.size() != 1) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test2(){
+    printf("test2: other policies and copies     ");
+    {
+        sjtu::deque<int, std::allocator<int>, sjtu::tree_blocks<>> q;
+        std::deque<int> stl;
+        if(!batches(q, stl, N)) {puts("Wrong Answer");return;}
+    }
+    {
+        sjtu::deque<int, std::allocator<int>, sjtu::fixed_block<64>> q;
+        std::deque<int> stl;
+        if(!batches(q, stl, N / 2)) {puts("Wrong Answer");return;}
+    }
+    // popping from a deque that shares its blocks leaves the copy alone
+    sjtu::deque<int> q;
+    std::deque<int> stl;
+    std::vector<int> v(100000);
+    for(size_t i = 0; i < v.size(); i++) v[i] = i;
+    q.push_back_n(v.data(), v.size());
+    stl.assign(v.begin(), v.end());
+    q.set_copy_on_write(true);
+    sjtu::deque<int> copy(q);
+    std::vector<int> got(30000);
+    q.pop_front_n(30000, got.data());
+    q.pop_back_n(30000);
+    q.push_front_n(v.data(), 10);
+    if(q.size() != 40010 || q[10] != 30000 || q[0] != 0 || !equal(copy, stl) || got[29999] != 29999)
+        {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+
+int live = 0;
+class Counted {
+public:
+    std::string s;
+    Counted(const std::string &s) : s(s) { live++; }
+    Counted(const Counted &other) : s(other.s) { live++; }
+    Counted(Counted &&other) noexcept : s(std::move(other.s)) { live++; }
+    Counted &operator=(const Counted &) = default;
+    Counted &operator=(Counted &&) = default;
+    ~Counted() { live--; }
+    bool operator==(const Counted &rhs) const { return s == rhs.s; }
+};
+// an output iterator that throws, before taking the value, once it has taken limit of them
+struct Limited {
+    std::vector<Counted> *to;
+    size_t limit;
+    Limited &operator*() { return *this; }
+    Limited &operator++() { return *this; }
+    Limited &operator=(Counted &&value) {
+        if(to->size() == limit) throw std::runtime_error("full");
+        to->push_back(std::move(value));
+        return *this;
+    }
+};
+// throws on the n-th copy
+int copies_left = -1;
+class Fragile {
+public:
+    int x;
+    Fragile(int x) : x(x) {}
+    Fragile(const Fragile &other) : x(other.x) {
+        if(copies_left == 0) throw std::runtime_error("copy");
+        if(copies_left > 0) copies_left--;
+    }
+    Fragile &operator=(const Fragile &) = default;
+    bool operator==(const Fragile &rhs) const { return x == rhs.x; }
+};
+void test3(){
+    printf("test3: non-trivial elements          ");
+    {
+        sjtu::deque<Counted> q;
+        std::deque<Counted> stl;
+        for(int i = 0; i < N / 4; i++){
+            std::vector<Counted> v;
+            size_t count = rand() % 200;
+            for(size_t k = 0; k < count; k++) v.push_back(Counted(std::to_string(rand())));
+            int op = rand() % 4;
+            if(op == 0) q.push_back_n(v.begin(), count), stl.insert(stl.end(), v.begin(), v.end());
+            else if(op == 1) q.push_front_n(v.cbegin(), count), stl.insert(stl.begin(), v.begin(), v.end());
+            else {
+                count = count < stl.size() ? count : stl.size();
+                std::vector<Counted> got;
+                if(op == 2){
+                    q.pop_front_n(count, std::back_inserter(got));
+                    if(!std::equal(got.begin(), got.end(), stl.begin())) {puts("Wrong Answer");return;}
+                    stl.erase(stl.begin(), stl.begin() + count);
+                } else {
+                    q.pop_back_n(count, std::back_inserter(got));
+                    if(!std::equal(got.begin(), got.end(), stl.end() - count)) {puts("Wrong Answer");return;}
+                    stl.erase(stl.end() - count, stl.end());
+                }
+            }
+            if(i % 100 == 0 && !equal(q, stl)) {puts("Wrong Answer");return;}
+        }
+        if(!equal(q, stl) || live != 2 * (int)stl.size()) {puts("Wrong Answer");return;}
+        // a write that throws leaves exactly the elements not written yet
+        for(int round = 0; round < 20 && stl.size() > 10; round++){
+            std::vector<Counted> got;
+            size_t count = 1 + rand() % stl.size(), limit = rand() % count;
+            bool front = round % 2, caught = false;
+            try{
+                if(front) q.pop_front_n(count, Limited{&got, limit});
+                else q.pop_back_n(count, Limited{&got, limit});
+            } catch(std::runtime_error &){
+                caught = true;
+            }
+            std::deque<Counted>::iterator from = front ? stl.begin() : stl.end() - count;
+            if(!caught || got.size() != limit || !std::equal(got.begin(), got.end(), from)) {puts("Wrong Answer");return;}
+            stl.erase(from, from + limit);
+            if(!equal(q, stl)) {puts("Wrong Answer");return;}
+        }
+    }
+    if(live != 0) {puts("Wrong Answer");return;}
+    // a constructor that throws midway keeps what was already added
+    sjtu::deque<Fragile> q;
+    std::vector<Fragile> v;
+    for(int i = 0; i < 5000; i++) v.push_back(Fragile(i));
+    q.push_back_n(v.begin(), 100);
+    copies_left = 3000;
+    bool caught = false;
+    try{ q.push_front_n(v.begin(), 5000); } catch(std::runtime_error &){ caught = true; }
+    if(!caught || q.size() != 3100 || q[0].x != 0 || q[2999].x != 2999 || q[3000].x != 0) {puts("Wrong Answer");return;}
+    copies_left = 10;
+    caught = false;
+    try{ q.push_back_n(v.begin(), 5000); } catch(std::runtime_error &){ caught = true; }
+    if(!caught || q.size() != 3110 || q.back().x != 9 || q[3099].x != 99) {puts("Wrong Answer");return;}
+    copies_left = -1;
+    q.push_front(Fragile(-1));
+    q.pop_front_n(3111);
+    if(!q.empty()) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//push_*_n, pop_*_n and drain_into, mixed with single operations
+    test2();//tree_blocks and fixed_block, and blocks shared by a copy
+    test3();//strings and a throwing copy constructor
+}
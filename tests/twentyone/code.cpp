@@ -0,0 +1,191 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <stdexcept>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mapped_deque.hpp"
+#include "exceptions.hpp"
+
+/***************************/
+int N = 300000;
+/***************************/
+
+const char *path = "twentyone.deque";
+
+struct Event {
+    long long time;
+    int id;
+    double value;
+    bool operator==(const Event &rhs) const { return time == rhs.time && id == rhs.id && value == rhs.value; }
+};
+Event make(int i){
+    Event e = {i * 7LL, rand(), i / 3.0};
+    return e;
+}
+
+template<class Q, class S>
+bool equal(const Q &q, const S &stl){
+    if(q.size() != stl.size()) return 0;
+    for(size_t i = 0; i < stl.size(); i++)
+        if(!(q[i] == stl[i])) return 0;
+    typename Q::const_iterator it = q.cbegin();
+    for(size_t i = 0; i < stl.size(); i++, ++it)
+        if(!(*it == stl[i])) return 0;
+    return it == q.cend();
+}
+void test1(){
+    printf("test1: against std::deque            ");
+    std::remove(path);
+    {
+        sjtu::mapped_deque<int, 4096> q(path);
+        std::deque<int> stl;
+        for(int i = 0; i < N; i++){
+            int x = rand(), op = rand() % 10;
+            if(op < 6) q.push_back(x), stl.push_back(x);
+            else if(stl.empty()) continue;
+            else if(op < 9) q.pop_front(), stl.pop_front();
+            else q.pop_back(), stl.pop_back();
+            if(!stl.empty()){
+                size_t p = rand() % stl.size();
+                if(q[p] != stl[p] || q.front() != stl.front() || q.back() != stl.back()) {puts("Wrong Answer");return;}
+            }
+        }
+        if(!equal(q, stl)) {puts("Wrong Answer");return;}
+        q.clear();
+        bool caught = false;
+        try{ q.pop_front(); } catch(std::out_of_range &){ caught = true; }
+        if(!caught || !q.empty()) {puts("Wrong Answer");return;}
+        for(int i = 0; i < 5000; i++) q.push_back(i);
+        if(q.size() != 5000 || q[4321] != 4321 || q.end() - q.begin() != 5000) {puts("Wrong Answer");return;}
+    }
+    std::remove(path);
+    puts("Accept");
+}
+void test2(){
+    printf("test2: reopen                        ");
+    std::remove(path);
+    std::deque<Event> stl;
+    {
+        sjtu::mapped_deque<Event, 8192> q(path);
+        for(int i = 0; i < N; i++){
+            Event e = make(i);
+            q.push_back(e), stl.push_back(e);
+            if(i % 3 == 0) q.pop_front(), stl.pop_front();
+        }
+        q.flush();
+    }
+    for(int round = 0; round < 3; round++){
+        sjtu::mapped_deque<Event, 8192> q(path);
+        if(!equal(q, stl)) {puts("Wrong Answer");return;}
+        for(int i = 0; i < N / 10; i++){
+            Event e = make(i);
+            q.push_back(e), stl.push_back(e);
+            q.pop_front(), stl.pop_front();
+        }
+    }
+    bool caught = false;
+    try{
+        sjtu::mapped_deque<int, 8192> wrong(path);
+    } catch(std::runtime_error &){
+        caught = true;
+    }
+    sjtu::mapped_deque<Event, 8192> q(path);
+    if(!caught || !equal(q, stl)) {puts("Wrong Answer");return;}
+    std::remove(path);
+    puts("Accept");
+}
+void test3(){
+    printf("test3: front pages are reclaimed     ");
+    std::remove(path);
+    sjtu::mapped_deque<long long, 4096> q(path);
+    std::deque<long long> stl;
+    size_t pages = 0;
+    for(long long i = 0; i < N * 10LL; i++){
+        q.push_back(i), stl.push_back(i);
+        if(stl.size() > 5000) q.pop_front(), stl.pop_front();  // a sliding window of 5000
+        if(i == N) pages = q.file_pages();
+    }
+    // the window needs 10 pages; the file stops growing once it is reached
+    if(q.file_pages() != pages || pages > 32 || !equal(q, stl)) {puts("Wrong Answer");return;}
+    struct stat st;
+    if(stat(path, &st) != 0 || st.st_size > 64 * 4096) {puts("Wrong Answer");return;}
+    std::remove(path);
+    puts("Accept");
+}
+// overwrite the 8-byte field at byte offset at of the file
+void poke(long at, unsigned long long value){
+    FILE *f = fopen(path, "r+b");
+    fseek(f, at, SEEK_SET);
+    fwrite(&value, sizeof(value), 1, f);
+    fclose(f);
+}
+unsigned long long peek(long at){
+    unsigned long long value = 0;
+    FILE *f = fopen(path, "rb");
+    fseek(f, at, SEEK_SET);
+    if(fread(&value, sizeof(value), 1, f) != 1) value = 0;
+    fclose(f);
+    return value;
+}
+// the file is rejected with std::runtime_error
+bool refused(){
+    try{
+        sjtu::mapped_deque<int, 4096> q(path);
+    } catch(std::runtime_error &){
+        return true;
+    }
+    return false;
+}
+void test4(){
+    printf("test4: moved-from and damaged files  ");
+    std::remove(path);
+    {
+        sjtu::mapped_deque<int, 4096> q(path);
+        for(int i = 0; i < 10000; i++) q.push_back(i);
+        sjtu::mapped_deque<int, 4096> taken(std::move(q));
+        int caught = 0;
+        try{ q.push_back(1); } catch(std::out_of_range &){ caught++; }
+        try{ q.pop_front(); } catch(std::out_of_range &){ caught++; }
+        try{ q.at(0); } catch(std::out_of_range &){ caught++; }
+        q.clear();
+        q.flush();
+        if(caught != 3 || !q.empty() || q.size() != 0 || q.file_pages() != 0 || q.begin() != q.end()
+           || taken.size() != 10000 || taken[9999] != 9999) {puts("Wrong Answer");return;}
+        q = std::move(taken);
+        if(q.size() != 10000 || !taken.empty()) {puts("Wrong Answer");return;}
+    }
+    // header fields: first 24, size 32, blocks 40, dir_page 48, dir_cap 56, dir_head 64, free_count 72, pages 80
+    const long fields[] = {32, 40, 48, 56, 64, 72, 80};
+    for(int k = 0; k < 7; k++){
+        unsigned long long old = peek(fields[k]);
+        poke(fields[k], 1ULL << 40);
+        if(!refused()) {puts("Wrong Answer");return;}
+        poke(fields[k], old);
+    }
+    // a block page number past the end of the file
+    unsigned long long dir_page = peek(48), head = peek(64);
+    unsigned long long old = peek(dir_page * 4096 + head * 8);
+    poke(dir_page * 4096 + head * 8, 1ULL << 40);
+    if(!refused()) {puts("Wrong Answer");return;}
+    poke(dir_page * 4096 + head * 8, old);
+    {
+        sjtu::mapped_deque<int, 4096> q(path);
+        if(q.size() != 10000 || q[1234] != 1234) {puts("Wrong Answer");return;}
+    }
+    // a file cut short, at a page boundary
+    if(truncate(path, 4096 * 3) != 0 || !refused()) {puts("Wrong Answer");return;}
+    std::remove(path);
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//push_back, pop_front and pop_back against std::deque
+    test2();//the contents survive closing and reopening the file
+    test3();//a sliding window keeps the file small
+    test4();//a moved-from deque is empty; a damaged header or directory is refused
+}
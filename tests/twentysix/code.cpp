@@ -0,0 +1,59 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include "deque.hpp"
+#include "exceptions.hpp"
+
+/***************************/
+int N = 100000;
+/***************************/
+
+// it was built on the element v; check it against [first, last) after the front moved
+template<class It>
+bool holds(It first, It last, const It &it, int v){
+    size_t at = v - *first;
+    if(*it != v || size_t(it - first) != at || last - it != (long)(last - first - at)) return 0;
+    if(it[50] != v + 50 || *(it + 50) != v + 50 || *(it - 50) != v - 50 || *(50 + it) != v + 50) return 0;
+    It back = it - 50 + 50;
+    if(back != it || !(it - 1 < it) || *--back != v - 1) return 0;
+    return 1;
+}
+template<class Q>
+bool front_pops(Q &q){
+    q.clear();
+    for(int i = 0; i < N; i++) q.push_back(i);
+    typename Q::iterator it = q.begin() + N / 2;
+    const Q &c = q;
+    typename Q::const_iterator cit = c.cbegin() + N / 2 + 1000;
+    // pop whole blocks (and more) off the front while holding the iterators
+    for(int round = 0; round < 20; round++){
+        for(int k = 0; k < 1000; k++) q.pop_front();
+        if(!holds(q.begin(), q.end(), it, N / 2) || !holds(c.cbegin(), c.cend(), cit, N / 2 + 1000)) return 0;
+    }
+    q.pop_front_n(3000);
+    if(!holds(q.begin(), q.end(), it, N / 2) || !holds(c.cbegin(), c.cend(), cit, N / 2 + 1000)) return 0;
+    // and then push some back in front
+    for(int k = 1; k <= 5000; k++) q.push_front(q.front() - 1);
+    if(!holds(q.begin(), q.end(), it, N / 2)) return 0;
+    return 1;
+}
+void test1(){
+    printf("test1: iterators across front pops   ");
+    sjtu::deque<int> q;
+    if(!front_pops(q)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test2(){
+    printf("test2: tree_blocks and fixed_block   ");
+    sjtu::deque<int, std::allocator<int>, sjtu::tree_blocks<>> t;
+    sjtu::deque<int, std::allocator<int>, sjtu::fixed_block<64>> f;
+    if(!front_pops(t) || !front_pops(f)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//- / + n / [] of an iterator held while pop_front drops blocks
+    test2();//the same through the block tree and fixed blocks
+}
@@ -0,0 +1,194 @@
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <new>
+#include <string>
+#include "bounded_deque.hpp"
+#include "exceptions.hpp"
+
+/***************************/
+int N = 1000000;
+/***************************/
+
+// operator new calls so far
+static long long allocations = 0;
+
+void *operator new(size_t size) {
+    ++allocations;
+    void *p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+// an allocator that is unusable once moved from; mismatched counts its uses in that state
+int mismatched = 0;
+template<class U>
+struct Tagged {
+    typedef U value_type;
+    int id;
+    Tagged(int id) : id(id) {}
+    template<class V> Tagged(const Tagged<V> &other) : id(other.id) {}
+    Tagged(const Tagged &other) = default;
+    Tagged(Tagged &&other) noexcept : id(other.id) { other.id = -1; }
+    Tagged &operator=(const Tagged &) = default;
+    U *allocate(size_t n) {
+        if(id < 0) mismatched++;
+        return static_cast<U *>(::operator new(n * sizeof(U)));
+    }
+    void deallocate(U *p, size_t) {
+        if(id < 0) mismatched++;
+        ::operator delete(p);
+    }
+    bool operator==(const Tagged &rhs) const { return id == rhs.id; }
+    bool operator!=(const Tagged &rhs) const { return id != rhs.id; }
+};
+
+template<class Q, class S>
+bool equal(Q &q, const S &stl){
+    if(q.size() != stl.size()) return 0;
+    for(size_t i = 0; i < stl.size(); i++)
+        if(!(q[i] == stl[i])) return 0;
+    typename Q::iterator it = q.begin();
+    for(size_t i = 0; i < stl.size(); i++, ++it)
+        if(!(*it == stl[i])) return 0;
+    return it == q.end() && q.end() - q.begin() == (long)stl.size();
+}
+void test1(){
+    printf("test1: a window against std::deque   ");
+    const size_t cap = 1000;
+    sjtu::bounded_deque<int> q(cap);
+    std::deque<int> stl;
+    for(int i = 0; i < N; i++){
+        int x = rand(), op = rand() % 8;
+        if(op < 4){
+            q.push_back(x), stl.push_back(x);
+            if(stl.size() > cap) stl.pop_front();
+        }
+        else if(op == 4){
+            q.push_front(x), stl.push_front(x);
+            if(stl.size() > cap) stl.pop_back();
+        }
+        else if(op == 5){
+            bool pushed = stl.size() < cap;
+            if(q.try_push_back(x) != pushed) {puts("Wrong Answer");return;}
+            if(pushed) stl.push_back(x);
+        }
+        else if(stl.empty()) continue;
+        else if(op == 6) q.pop_front(), stl.pop_front();
+        else q.pop_back(), stl.pop_back();
+        if(q.full() != (stl.size() == cap)) {puts("Wrong Answer");return;}
+        if(!stl.empty()){
+            size_t p = rand() % stl.size();
+            if(q[p] != stl[p] || q.front() != stl.front() || q.back() != stl.back()) {puts("Wrong Answer");return;}
+        }
+        if(i % 9973 == 0 && !equal(q, stl)) {puts("Wrong Answer");return;}
+    }
+    if(!equal(q, stl)) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test2(){
+    printf("test2: no allocation after the start ");
+    sjtu::bounded_deque<long long> q(4096);
+    long long before = allocations, sum = 0;
+    for(long long i = 0; i < N * 10LL; i++){
+        q.push_back(i);
+        if(i % 3 == 0 && i < N) q.pop_front();
+        if(!q.empty()) sum += q.back() - q.front();
+    }
+    if(allocations != before || !q.full() || q.front() != N * 10LL - 4096) {puts("Wrong Answer");return;}
+    // std algorithms through the iterators
+    std::sort(q.begin(), q.end(), [](long long a, long long b){ return a > b; });
+    if(q.front() != N * 10LL - 1 || q.back() != N * 10LL - 4096 || allocations != before) {puts("Wrong Answer");return;}
+    bool caught = false;
+    try{
+        sjtu::bounded_deque<int> none(0);
+    } catch(std::out_of_range &){
+        caught = true;
+    }
+    sjtu::bounded_deque<int> e(3);
+    try{ e.pop_back(); caught = false; } catch(std::out_of_range &){}
+    if(!caught || sum == 0) {puts("Wrong Answer");return;}
+    // a moved-from deque is empty without a ring, refuses pushes, and takes a new one by assignment
+    sjtu::bounded_deque<int> taken(std::move(e)), copy(e);
+    int refused = 0;
+    try{ e.push_back(1); } catch(std::out_of_range &){ refused++; }
+    try{ e.emplace_front(1); } catch(std::out_of_range &){ refused++; }
+    if(refused != 2 || e.try_push_back(1) || e.try_push_front(1) || !e.empty() || e.capacity() != 0
+       || e.begin() != e.end() || copy.capacity() != 0 || taken.capacity() != 3) {puts("Wrong Answer");return;}
+    e = taken;
+    e.push_back(4), e.push_front(5);
+    if(e.size() != 2 || e.front() != 5 || e.capacity() != 3) {puts("Wrong Answer");return;}
+    // a moved ring is freed through the allocator that came with it, not the moved-from one
+    {
+        sjtu::bounded_deque<int, Tagged<int>> from(8, Tagged<int>(7));
+        from.push_back(1);
+        sjtu::bounded_deque<int, Tagged<int>> to(std::move(from));
+        if(to.front() != 1 || !from.empty()) {puts("Wrong Answer");return;}
+    }
+    if(mismatched != 0) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+
+int live = 0;
+class Counted {
+public:
+    std::string s;
+    Counted(const std::string &s) : s(s) { live++; }
+    Counted(const Counted &other) : s(other.s) { live++; }
+    Counted(Counted &&other) noexcept : s(std::move(other.s)) { live++; }
+    Counted &operator=(const Counted &) = default;
+    Counted &operator=(Counted &&) = default;
+    ~Counted() { live--; }
+    bool operator==(const Counted &rhs) const { return s == rhs.s; }
+};
+void test3(){
+    printf("test3: non-trivial elements          ");
+    {
+        typedef sjtu::bounded_deque<Counted> Q;
+        Q q(37);
+        std::deque<Counted> stl;
+        for(int i = 0; i < N / 10; i++){
+            Counted x(std::to_string(rand()));
+            int op = rand() % 5;
+            if(op < 2){
+                q.push_back(x), stl.push_back(x);
+                if(stl.size() > 37) stl.pop_front();
+            }
+            else if(op == 2){
+                q.emplace_front(x.s), stl.push_front(x);
+                if(stl.size() > 37) stl.pop_back();
+            }
+            else if(op == 3 && !stl.empty()){
+                q.push_back(q.front()), stl.push_back(stl.front());  // may overwrite the element it copies
+                if(stl.size() > 37) stl.pop_front();
+            }
+            else if(!stl.empty()) q.pop_front(), stl.pop_front();
+            if(i % 100 == 0){
+                Q copy(q), moved(1);
+                moved = std::move(copy);
+                if(!equal(moved, stl)) {puts("Wrong Answer");return;}
+                Q other(5);
+                other.push_back(x);
+                other.swap(moved);
+                if(!equal(other, stl) || moved.size() != 1 || moved.capacity() != 5) {puts("Wrong Answer");return;}
+            }
+        }
+        if(!equal(q, stl)) {puts("Wrong Answer");return;}
+        q.clear();
+        if(!q.empty() || live != (int)stl.size()) {puts("Wrong Answer");return;}
+    }
+    if(live != 0) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//push_back / push_front slide the window
+    test2();//operator new is never called again
+    test3();//copies, moves and swaps of strings
+}
@@ -0,0 +1,211 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "deque.hpp"
+#include "exceptions.hpp"
+#include "class-bint.hpp"
+
+/***************************/
+int N = 200000;
+/***************************/
+
+// the serialized form of Util::Bint: its decimal digits, behind their length
+namespace sjtu {
+template <>
+struct deque_serial<Util::Bint> {
+    template <class Writer>
+    static void write(const Util::Bint &value, Writer &write) {
+        std::ostringstream os;
+        os << value;
+        std::string digits = os.str();
+        unsigned long long length = digits.size();
+        deque_span spans[2] = {{&length, sizeof(length)}, {digits.data(), digits.size()}};
+        write(static_cast<const deque_span *>(spans), size_t(2));
+    }
+    template <class Reader>
+    static Util::Bint read(Reader &read) {
+        unsigned long long length;
+        read(static_cast<void *>(&length), sizeof(length));
+        std::string digits(length, '0');
+        read(static_cast<void *>(&digits[0]), length);
+        return Util::Bint(digits);
+    }
+};
+}
+
+// a writer that gathers the spans into one string, and a reader over such a string
+struct StringWriter {
+    std::string out;
+    size_t calls = 0, spans = 0;
+    void operator()(const sjtu::deque_span *s, size_t n) {
+        calls++, spans += n;
+        for (size_t i = 0; i < n; i++) out.append(static_cast<const char *>(s[i].data), s[i].size);
+    }
+};
+struct StringReader {
+    const std::string &in;
+    size_t at;
+    void operator()(void *dest, size_t bytes) {
+        if (bytes > in.size() - at) throw std::out_of_range("end of input");
+        memcpy(dest, in.data() + at, bytes);
+        at += bytes;
+    }
+};
+
+template<class Q, class S>
+bool equal(Q &q, const S &stl){
+    if(q.size() != stl.size()) return 0;
+    for(size_t i = 0; i < stl.size(); i++)
+        if(!(q[i] == stl[i])) return 0;
+    return 1;
+}
+template<class Q, class S>
+void workload(Q &q, S &stl, int n){
+    for(int i = 0; i < n; i++){
+        int x = rand(), op = rand() % 5;
+        if(op == 0) q.push_front(x), stl.push_front(x);
+        else if(op == 1 && !stl.empty()){
+            size_t p = rand() % (stl.size() + 1);
+            q.insert(q.begin() + p, x), stl.insert(stl.begin() + p, x);
+        }
+        else if(op == 2 && !stl.empty()){
+            size_t p = rand() % stl.size();
+            q.erase(q.begin() + p), stl.erase(stl.begin() + p);
+        }
+        else q.push_back(x), stl.push_back(x);
+    }
+}
+void test1(){
+    printf("test1: round trip through spans      ");
+    sjtu::deque<int> q;
+    std::deque<int> stl;
+    workload(q, stl, N);
+    size_t at = 0;
+    bool inside = true;
+    auto check = [&](const sjtu::deque_span *s, size_t n){
+        // every element span is block storage: it starts at the element it holds
+        for(size_t i = 1; i < n; i++){
+            if(s[i].data != &q[at]) inside = false;
+            at += s[i].size / sizeof(int);
+        }
+    };
+    q.serialize(check);
+    if(!inside || at != stl.size()) {puts("Wrong Answer");return;}
+    StringWriter w;
+    q.serialize(w);
+    if(w.calls != 1 || w.out.size() != sizeof(sjtu::deque_wire_header) + stl.size() * sizeof(int))
+        {puts("Wrong Answer");return;}
+    sjtu::deque<int> r;
+    r.push_back(7);
+    StringReader reader{w.out, 0};
+    r.deserialize(reader);
+    if(reader.at != w.out.size() || !equal(r, stl)) {puts("Wrong Answer");return;}
+    workload(r, stl, N / 10);
+    if(!equal(r, stl)) {puts("Wrong Answer");return;}
+    // a truncated input, and one written for another element type, leave r as it was
+    std::string cut = w.out.substr(0, w.out.size() / 2);
+    bool caught = false;
+    try{
+        StringReader half{cut, 0};
+        r.deserialize(half);
+    } catch(std::out_of_range &){
+        caught = true;
+    }
+    if(!caught || !equal(r, stl)) {puts("Wrong Answer");return;}
+    sjtu::deque<long long> wide;
+    caught = false;
+    try{
+        StringReader other{w.out, 0};
+        wide.deserialize(other);
+    } catch(std::runtime_error &){
+        caught = true;
+    }
+    if(!caught || !wide.empty()) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test2(){
+    printf("test2: adopting buffers              ");
+    std::allocator<int> alloc;
+    std::deque<int> stl;
+    sjtu::deque_buffer<int> bufs[40];
+    for(int k = 0; k < 40; k++){
+        size_t cap = 1 << (4 + k % 8);
+        int *data = alloc.allocate(cap);
+        size_t count = rand() % (cap + 1);
+        for(size_t i = 0; i < count; i++) data[i] = rand(), stl.push_back(data[i]);
+        bufs[k] = sjtu::deque_buffer<int>{data, cap, count};
+    }
+    sjtu::deque<int> q(sjtu::adopt_buffers_t(), bufs, bufs + 40);
+    // the buffers are the blocks, not copies of them (but for the few Balance() has already fixed)
+    std::set<const void *> storage;
+    q.serialize([&](const sjtu::deque_span *s, size_t n){
+        for(size_t i = 1; i < n; i++) storage.insert(s[i].data);
+    });
+    int kept = 0, full = 0;
+    for(int k = 0; k < 40; k++) if(bufs[k].count) full++, kept += storage.count(bufs[k].data);
+    if(kept < full - 4 || !equal(q, stl)) {puts("Wrong Answer");return;}
+    workload(q, stl, N);
+    if(!equal(q, stl)) {puts("Wrong Answer");return;}
+    // a capacity that is not a power of two is refused, and the buffer stays the caller's
+    int *odd = alloc.allocate(100);
+    sjtu::deque_buffer<int> bad[2] = {{alloc.allocate(64), 64, 0}, {odd, 100, 0}};
+    bool caught = false;
+    try{
+        sjtu::deque<int> r(sjtu::adopt_buffers_t(), bad, bad + 2);
+    } catch(std::out_of_range &){
+        caught = true;
+    }
+    alloc.deallocate(bad[0].data, 64);
+    alloc.deallocate(odd, 100);
+    if(!caught) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+void test3(){
+    printf("test3: Bint through deque_serial     ");
+    sjtu::deque<Util::Bint> q;
+    std::deque<Util::Bint> stl;
+    for(int i = 0; i < 2000; i++){
+        Util::Bint x = Util::Bint((long long)rand() * rand()) * Util::Bint(rand() - RAND_MAX / 2);
+        if(i % 3) q.push_back(x), stl.push_back(x);
+        else q.push_front(x), stl.push_front(x);
+    }
+    StringWriter w;
+    q.serialize(w);
+    if(w.calls != 1 + 2000 || w.spans != 1 + 2 * 2000) {puts("Wrong Answer");return;}
+    // serializing a copy-on-write snapshot reads its blocks without unsharing them
+    q.set_copy_on_write(true);
+    const sjtu::deque<Util::Bint> snapshot(q);
+    size_t allocations = snapshot.memory_stats().allocations;
+    StringWriter again;
+    snapshot.serialize(again);
+    if(again.out != w.out || snapshot.memory_stats().allocations != allocations) {puts("Wrong Answer");return;}
+    sjtu::deque<Util::Bint> r;
+    StringReader reader{w.out, 0};
+    r.deserialize(reader);
+    if(reader.at != w.out.size() || !equal(r, stl)) {puts("Wrong Answer");return;}
+    sjtu::deque<int> ints;
+    bool caught = false;
+    try{
+        StringReader other{w.out, 0};
+        ints.deserialize(other);
+    } catch(std::runtime_error &){
+        caught = true;
+    }
+    if(!caught) {puts("Wrong Answer");return;}
+    puts("Accept");
+}
+int main(){
+    srand(time(NULL));
+    puts("test start:");
+    test1();//spans point into the blocks, against std::deque after reading back
+    test2();//buffers become blocks as they are
+    test3();//the customization point for a non-trivial type
+}
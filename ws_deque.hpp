@@ -0,0 +1,145 @@
+#ifndef SJTU_WS_DEQUE_HPP
+#define SJTU_WS_DEQUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace sjtu {
+
+/**
+ * Chase-Lev work-stealing deque. One owner thread calls push_back and
+ * pop_back at the bottom end; any number of thieves call steal at the
+ * top end. Owner operations are lock-free and only synchronise with a
+ * thief when both go for the last element; steal is a single CAS on top.
+ * The memory orders follow Le, Pop, Cohen and Zappa Nardelli, "Correct
+ * and Efficient Work-Stealing for Weak Memory Models" (PPoPP 2013).
+ *
+ * Storage is one power-of-two ring, like a deque block: element i is
+ * slot i & (capacity - 1). When the owner fills it, the live range is
+ * copied into a ring twice the size and the old one is retired. A thief
+ * may still be reading a retired ring, so retired rings are only freed
+ * by the destructor (the total is bounded by the final ring's size).
+ *
+ * A thief reads its slot before it knows whether its CAS wins, so slots
+ * are std::atomic<T> and T must be trivially copyable; schedule tasks
+ * by pointer or index.
+ */
+template <class T>
+class ws_deque {
+  static_assert(std::is_trivially_copyable<T>::value, "ws_deque elements must be trivially copyable");
+
+private:
+  struct Ring {
+    std::ptrdiff_t mask;
+    std::atomic<T> *slots;
+    Ring *retired;  // the ring this one replaced, kept alive for thieves
+
+    explicit Ring(std::ptrdiff_t capacity)
+      : mask(capacity - 1), slots(new std::atomic<T>[capacity]), retired(nullptr) {}
+    ~Ring() { delete[] slots; }
+
+    std::ptrdiff_t capacity() const { return mask + 1; }
+    void put(std::ptrdiff_t i, const T &value) { slots[i & mask].store(value, std::memory_order_relaxed); }
+    T get(std::ptrdiff_t i) const { return slots[i & mask].load(std::memory_order_relaxed); }
+  };
+
+  static const std::size_t kLine = 64;
+
+  alignas(kLine) std::atomic<std::ptrdiff_t> top{0};     // thieves' end
+  alignas(kLine) std::atomic<std::ptrdiff_t> bottom{0};  // owner's end
+  std::atomic<Ring *> ring;
+
+  // owner: move [t, b) into a ring twice the size
+  Ring *Grow(Ring *old, std::ptrdiff_t t, std::ptrdiff_t b) {
+    Ring *bigger = new Ring(old->capacity() * 2);
+    for (std::ptrdiff_t i = t; i < b; ++i) bigger->put(i, old->get(i));
+    bigger->retired = old;
+    ring.store(bigger, std::memory_order_release);
+    return bigger;
+  }
+
+public:
+  // capacity is rounded up to a power of two
+  explicit ws_deque(std::size_t capacity = 64) {
+    std::ptrdiff_t cap = 2;
+    while (cap < static_cast<std::ptrdiff_t>(capacity)) cap <<= 1;
+    ring.store(new Ring(cap), std::memory_order_relaxed);
+  }
+
+  ws_deque(const ws_deque &) = delete;
+  ws_deque &operator=(const ws_deque &) = delete;
+
+  // not concurrent with any other member
+  ~ws_deque() {
+    Ring *r = ring.load(std::memory_order_relaxed);
+    while (r) {
+      Ring *older = r->retired;
+      delete r;
+      r = older;
+    }
+  }
+
+  // owner only
+  void push_back(const T &value) {
+    std::ptrdiff_t b = bottom.load(std::memory_order_relaxed);
+    std::ptrdiff_t t = top.load(std::memory_order_acquire);
+    Ring *r = ring.load(std::memory_order_relaxed);
+    if (b - t > r->mask) r = Grow(r, t, b);
+    r->put(b, value);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+  }
+
+  // owner only. takes the most recently pushed element; false when empty
+  bool pop_back(T &out) {
+    std::ptrdiff_t b = bottom.load(std::memory_order_relaxed) - 1;
+    Ring *r = ring.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::ptrdiff_t t = top.load(std::memory_order_relaxed);
+    if (t > b) {  // was empty
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return false;
+    }
+    out = r->get(b);
+    if (t == b) {  // the last element: race the thieves for it
+      bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+      bottom.store(b + 1, std::memory_order_relaxed);
+      return won;
+    }
+    return true;
+  }
+
+  /**
+   * any thread. takes the oldest element. false when the deque is empty
+   * or another thief (or the owner) took that element first; callers
+   * usually just try again or move on to another victim.
+   */
+  bool steal(T &out) {
+    std::ptrdiff_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::ptrdiff_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) return false;
+    Ring *r = ring.load(std::memory_order_acquire);
+    T value = r->get(t);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      return false;
+    out = value;
+    return true;
+  }
+
+  // a snapshot, possibly stale by the time it returns
+  std::size_t size() const {
+    std::ptrdiff_t b = bottom.load(std::memory_order_relaxed);
+    std::ptrdiff_t t = top.load(std::memory_order_relaxed);
+    return b > t ? static_cast<std::size_t>(b - t) : 0;
+  }
+  bool empty() const { return size() == 0; }
+  std::size_t capacity() const { return ring.load(std::memory_order_relaxed)->capacity(); }
+};
+
+} // namespace sjtu
+
+#endif